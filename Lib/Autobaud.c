@@ -0,0 +1,225 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Autobaud.h"
+
+#ifdef RADIO_USE_AUTOBAUD
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef AUTOBAUD_Pin
+#error "error: AUTOBAUD_Pin needs to be defined as the serial receiver RX pin (e.g PA10)"
+#endif
+
+#define AUTOBAUD_TICK_HZ		1000000	// US_Read() resolution
+#define AUTOBAUD_IDLE_US		300		// Gap longer than any run of equal bits inside a byte
+#define AUTOBAUD_EDGE_MIN		16		// Fewer intervals than this is not a serial stream
+#define AUTOBAUD_RUN_MAX		10		// Longest run of equal bits expected inside a byte (8E2)
+#define AUTOBAUD_REFINE			3		// Passes used to refine the bit time estimate
+#define AUTOBAUD_TOLERANCE		25		// Snap to a standard rate within 1/25 (4%)
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void 	AUTOBAUD_Calculate	( AUTOBAUD_t * );
+static uint32_t	AUTOBAUD_Snap		( uint32_t );
+
+static void 	AUTOBAUD_IRQ		( void );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static const uint32_t standardBaud[] = { 100000, 115200, 200000, 400000, 416666, 420000 };
+
+// Measurement in progress. The pin interrupt handler takes no arguments
+static AUTOBAUD_t * volatile active = NULL;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * AUTOBAUD_Start
+ *  - Claims AUTOBAUD_Pin as a GPIO input and begins timestamping edges into ab.
+ *  - The serial UART must not be initialised on the pin until AUTOBAUD_Stop().
+ */
+void AUTOBAUD_Start ( AUTOBAUD_t * ab )
+{
+	memset( ab, 0, sizeof(*ab) );
+
+	GPIO_EnableInput( AUTOBAUD_Pin, GPIO_Pull_None );
+	ab->startLevel	= GPIO_Read( AUTOBAUD_Pin );
+	ab->start		= CORE_GetTick();
+	ab->tick		= US_Read();
+	active			= ab;
+
+	GPIO_OnChange( AUTOBAUD_Pin, GPIO_IT_Both, AUTOBAUD_IRQ );
+}
+
+/*
+ * AUTOBAUD_Update
+ *  - Non-blocking. Returns true once the measurement is complete and
+ *    AUTOBAUD_getResult() can be read.
+ */
+bool AUTOBAUD_Update ( AUTOBAUD_t * ab )
+{
+	if ( ab->done ) { return true; }
+
+	if ( ab->count < AUTOBAUD_EDGE_NUM && (CORE_GetTick() - ab->start) < AUTOBAUD_WINDOW_MS ) {
+		return false;
+	}
+
+	GPIO_OnChange( AUTOBAUD_Pin, GPIO_IT_None, NULL );
+	active = NULL;
+	AUTOBAUD_Calculate( ab );
+	ab->done = true;
+
+	return true;
+}
+
+/*
+ * AUTOBAUD_Stop
+ *  - Releases AUTOBAUD_Pin so the UART can take it over.
+ *  - The result stays readable until ab is reused.
+ */
+void AUTOBAUD_Stop ( AUTOBAUD_t * ab )
+{
+	GPIO_OnChange( AUTOBAUD_Pin, GPIO_IT_None, NULL );
+	GPIO_Deinit( AUTOBAUD_Pin );
+	if ( active == ab ) { active = NULL; }
+}
+
+/*
+ * AUTOBAUD_getResult
+ *  -
+ */
+AUTOBAUD_Result* AUTOBAUD_getResult ( AUTOBAUD_t * ab )
+{
+	return &ab->result;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * AUTOBAUD_Calculate
+ *  - Intervals within one tick of the shortest are single bits; their mean seeds
+ *    the bit time (quantisation averages out). Every interval is then expressed
+ *    as a whole number of bits and averaged to refine it.
+ */
+static void AUTOBAUD_Calculate ( AUTOBAUD_t * ab )
+{
+	// Idle polarity - level the line sat at during inter-frame gaps
+	if ( ab->idleHigh || ab->idleLow ) {
+		ab->result.inverted = ab->idleLow > ab->idleHigh;
+	} else {
+		ab->result.inverted = !ab->startLevel;
+	}
+
+	if ( ab->count < AUTOBAUD_EDGE_MIN ) { return; }
+
+	// Shortest interval
+	uint32_t shortest = UINT32_MAX;
+	for ( uint8_t i = 0; i < ab->count; i++ ) {
+		if ( ab->interval[i] && ab->interval[i] < shortest ) {
+			shortest = ab->interval[i];
+		}
+	}
+	if ( shortest == UINT32_MAX ) { return; }
+
+	// Seed bit time (Q8 ticks) from the single bit intervals
+	uint32_t sumTime = 0;
+	uint32_t sumBits = 0;
+	for ( uint8_t i = 0; i < ab->count; i++ ) {
+		if ( ab->interval[i] && ab->interval[i] <= shortest + 1 ) {
+			sumTime += ab->interval[i];
+			sumBits++;
+		}
+	}
+	uint32_t bitQ8 = (sumTime << 8) / sumBits;
+
+	// Refine using every interval
+	for ( uint8_t pass = 0; pass < AUTOBAUD_REFINE; pass++ )
+	{
+		sumTime = 0;
+		sumBits = 0;
+		for ( uint8_t i = 0; i < ab->count; i++ ) {
+			uint32_t bits = (((uint32_t)ab->interval[i] << 8) + (bitQ8 / 2)) / bitQ8;
+			if ( bits >= 1 && bits <= AUTOBAUD_RUN_MAX ) {
+				sumTime += ab->interval[i];
+				sumBits += bits;
+			}
+		}
+		if ( sumBits ) {
+			bitQ8 = (sumTime << 8) / sumBits;
+		}
+	}
+	if ( bitQ8 == 0 ) { return; }
+
+	ab->result.baud  = AUTOBAUD_Snap( ((uint32_t)AUTOBAUD_TICK_HZ << 8) / bitQ8 );
+	ab->result.valid = true;
+}
+
+/*
+ * AUTOBAUD_Snap
+ *  - Rounds to the nearest standard rate if within AUTOBAUD_TOLERANCE.
+ *    Otherwise keeps the measured (non-standard) rate.
+ */
+static uint32_t AUTOBAUD_Snap ( uint32_t baud )
+{
+	uint32_t best = baud;
+	uint32_t bestError = UINT32_MAX;
+	for ( uint8_t i = 0; i < sizeof(standardBaud) / sizeof(standardBaud[0]); i++ ) {
+		uint32_t error = standardBaud[i] > baud ? standardBaud[i] - baud : baud - standardBaud[i];
+		if ( error < bestError ) {
+			bestError = error;
+			best = standardBaud[i];
+		}
+	}
+
+	return bestError <= (baud / AUTOBAUD_TOLERANCE) ? best : baud;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * AUTOBAUD_IRQ
+ *  - Both edges of AUTOBAUD_Pin.
+ */
+static void AUTOBAUD_IRQ ( void )
+{
+	AUTOBAUD_t * ab = active;
+	if ( ab == NULL ) { return; }
+
+	uint32_t now	= US_Read();
+	bool level		= GPIO_Read( AUTOBAUD_Pin );
+	uint32_t dt		= now - ab->tick;
+	ab->tick = now;
+
+	// Long gap - the line was idling at the level before this edge
+	if ( dt >= AUTOBAUD_IDLE_US ) {
+		if ( level ) { ab->idleLow++;  }
+		else 		 { ab->idleHigh++; }
+	}
+	else if ( ab->count < AUTOBAUD_EDGE_NUM ) {
+		ab->interval[ab->count++] = dt;
+	}
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,69 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef AUTOBAUD_H
+#define AUTOBAUD_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+#include "Core.h"
+#include "GPIO.h"
+#include "US.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Edges are timestamped with US_Read(), so US_Init() must have been called.
+ * A 1us timebase resolves rates up to ~450 kbaud (CRSF 420k). Faster links
+ * measure as a non-standard rate, fail to lock, and detection falls back to
+ * the normal protocol sweep.
+ */
+#define AUTOBAUD_WINDOW_MS		60		// Longest time spent listening to the RX pin
+#define AUTOBAUD_EDGE_NUM		128		// Edge intervals captured before finishing early
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef struct {
+	bool 		valid;		// Enough serial traffic was seen to trust the result
+	bool 		inverted;	// Line idles low (e.g SBUS)
+	uint32_t 	baud;		// Snapped to a standard rate when close enough
+} AUTOBAUD_Result;
+
+/*
+ * Measurement state. Only needed between AUTOBAUD_Start() and reading the result,
+ * so the caller can keep it in memory it reuses once a protocol is running.
+ * Idle gaps are counted rather than stored, so intervals fit in 16 bits.
+ */
+typedef struct {
+	volatile uint16_t	interval[AUTOBAUD_EDGE_NUM];
+	volatile uint8_t	count;
+	volatile uint8_t	idleHigh;
+	volatile uint8_t	idleLow;
+	volatile uint32_t	tick;
+
+	uint32_t			start;
+	bool 				startLevel;
+	bool 				done;
+	AUTOBAUD_Result		result;
+} AUTOBAUD_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void 				AUTOBAUD_Start		( AUTOBAUD_t * );
+bool 				AUTOBAUD_Update		( AUTOBAUD_t * );
+void 				AUTOBAUD_Stop		( AUTOBAUD_t * );
+
+AUTOBAUD_Result*	AUTOBAUD_getResult	( AUTOBAUD_t * );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* AUTOBAUD_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
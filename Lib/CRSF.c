@@ -1,401 +1,805 @@
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#include "CRSF.h"
-
-#ifdef RADIO_USE_CRSF
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE DEFINITIONS                               */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#ifdef RADIO_USE_CRSF
-#ifndef CRSF_UART
-#error "error: CRSF_UART needs to be defined (e.g UART_1)"
-#endif
-#ifndef UART1_PINS
-#error "error: UART1_PINS needs to be defined (e.g GPIO_PIN_7)"
-#endif
-#ifndef UART1_AF
-#error "error: UART1_AF needs to be defined (e.g GPIO_AF0_USART1)"
-#endif
-#endif
-
-#define CRSF_TICKS_TO_US(x)  ((x - 992) * 5 / 8 + 1500)
-#define CRSF_US_TO_TICKS(x)  ((x - 1500) * 8 / 5 + 992)
-
-#define CRSF_BAUD				420000
-#define CRSF_PERIOD_MS			4
-#define CRSF_TIMEOUT_PACKET_MS  2
-#define CRSF_TIMEOUT_RADIO_MS	100//(CRSF_PERIOD_MS * 10)
-
-#define CRSF_LEN_SYNC           1
-#define CRSF_LEN_LENGTH         1
-#define CRSF_LEN_TYPE       	1
-#define CRSF_LEN_CRC8       	1
-#define CRSF_LEN_PACKET_MIN     3
-#define CRSF_LEN_PACKET_MAX     64
-
-#define CRSF_INDEX_SYNC         0
-#define CRSF_INDEX_LENGTH       1
-#define CRSF_INDEX_PAYLOAD      2
-
-#define CRSF_SYNC          		0xC8
-
-// Channel transformation constants (calibration values)
-#define CRSF_MIN             	172
-#define CRSF_MIN_1000           191
-#define CRSF_CENTER				992
-#define CRSF_MAX_2000           1792
-#define CRSF_MAX                1811
-#define CRSF_THRESHOLD          10
-#define CRSF_RANGE              (CRSF_MAX - CRSF_MIN)
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE TYPES                                        */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE PROTOTYPES                                   */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-static CRSF_frameType_e CRSF_Decode					( void );
-static inline void	CRSF_DecodeFrame_ChannelsRC	( void );
-static inline void 	CRSF_DecodeFrame_LinkStats 	( void );
-static uint8_t 		CRSF_CalcCRC8				( const uint8_t *, uint8_t );
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE VARIABLES                                 */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-static uint32_t idx							= CRSF_INDEX_SYNC;
-static uint32_t	packetStart					= 0;
-static uint32_t	lastValidPacket 			= 0;
-static uint8_t 	payloadLen 					= 0;
-
-static uint8_t  rx[CRSF_LEN_PACKET_MAX]		= {0};
-static uint32_t	data[CRSF_CH_NUM]			= {0};
-static uint32_t	raw[CRSF_CH_NUM]			= {0};
-
-static bool 	inputLost 					= true;
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS                                  */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/*
- * CRSF_Init
- *  -
- */
-void CRSF_Init ( void )
-{
-    memset( rx,   0, sizeof(rx) );
-    idx 			= CRSF_INDEX_SYNC;
-    packetStart		= 0;
-   	lastValidPacket = 0;
-    payloadLen 		= 0;
-
-    memset( data, 0, sizeof(data) );
-    inputLost = true;
-
-    UART_Init(		CRSF_UART, CRSF_BAUD, UART_Mode_Default );
-    UART_ReadFlush( CRSF_UART );
-}
-
-/*
- * CRSF_Deinit
- *  -
- */
-void CRSF_Deinit ( void )
-{
-    UART_Deinit( CRSF_UART );
-}
-
-/*
- * CRSF_Detect
- *  -
- */
-bool CRSF_Detect ( void )
-{
-    CRSF_Init();
-    uint32_t start = CORE_GetTick();
-
-    while ( (CORE_GetTick() - start) < CRSF_TIMEOUT_RADIO_MS )
-    {
-        CRSF_Update();
-        CORE_Idle();
-    }
-
-    if ( inputLost ) {
-        CRSF_Deinit();
-    }
-
-    return !inputLost;
-}
-
-/*
- * CRSF_Update
- *  -
- */
-void CRSF_Update ( void )
-{
-	static uint32_t countGood =0;
-	static uint32_t countBad =0;
-	static uint32_t countBadCRC =0;
-	static uint32_t countBadIL =0;
-	static uint32_t countValidPacket =0;
-	static uint32_t countotherPAcket =0;
-    uint8_t byte;
-
-    while ( UART_ReadCount(CRSF_UART) )
-    {
-        UART_Read(CRSF_UART, &byte, 1);
-
-        // LOOKING FOR PROTOCOL SYNC BYTE
-        if ( idx == CRSF_INDEX_SYNC ) { // want this check after length check so can cascade into it on a failed length check
-			// Confirm data is CRSF sync byte
-			if ( byte == CRSF_SYNC ) {
-    		    memset( rx, 0, sizeof(rx) );
-				rx[CRSF_INDEX_SYNC]	= byte;
-				idx = CRSF_INDEX_LENGTH;
-				packetStart = CORE_GetTick();
-			}
-		}
-
-        // LOOK FOR VALID PROTOCOL LENGTH BYTE
-        else if ( idx == CRSF_INDEX_LENGTH ) {
-        	// Confirm valid packet length
-        	if ( byte >= CRSF_LEN_PACKET_MIN && byte <= (CRSF_LEN_PACKET_MAX - CRSF_LEN_SYNC - CRSF_LEN_CRC8) ) {
-            	rx[CRSF_INDEX_LENGTH] = byte;
-            	payloadLen = CRSF_LEN_SYNC + CRSF_LEN_LENGTH + rx[CRSF_INDEX_LENGTH];
-            	idx = CRSF_INDEX_PAYLOAD;
-            	countGood++;
-            // Failed check
-        	} else {
-        		idx = CRSF_INDEX_SYNC;
-        		countBad++;
-        	}
-        }
-
-        // WAIT TO READ IN FULL PAYLOAD
-        else {
-        	rx[idx] = byte;
-
-        	// Check for complete payload Rx
-        	if ( idx >= (payloadLen-1) )
-        	{
-        		uint8_t crc = CRSF_CalcCRC8( &rx[CRSF_INDEX_PAYLOAD], rx[CRSF_INDEX_LENGTH]-1 );
-        		// Calculate checksum to verify Payload
-         		if ( crc  == rx[payloadLen-1] ) {
-         			CRSF_frameType_e packet = CRSF_Decode();
-         			if ( packet == CRSF_FRAMETYPE_RC_CHANNELS ) {
-            			inputLost = false;
-            			lastValidPacket = CORE_GetTick();
-            			countValidPacket++;
-//            		    memset( rx, 0, sizeof(rx) );
-         			} else {
-         				countotherPAcket++;
-         			}
-        		}
-         		else {
-         			countBadCRC ++;
-         		}
-        		idx = CRSF_INDEX_SYNC;
-        	}
-        	else { idx++; }
-        }
-    }
-
-
-	uint32_t now = CORE_GetTick();
-
-	if ( countGood >1000 ||
-	 countBad >1000 ||
-	 countBadCRC >1000 ||
-	 countBadIL >1000 ||
-	 countValidPacket >1000 ||
-	 countotherPAcket >1000 )
-	{
-//		inputLost = true;
-	}
-
-	// TIMEOUT MID PAYLOAD - ABORT TRANSMISSION
-	if ( idx != CRSF_INDEX_SYNC && (now - packetStart) >= CRSF_TIMEOUT_PACKET_MS ) {
-		idx = CRSF_INDEX_SYNC;
-	}
-	// TIMEOUT WITH RADIO
-	if ( !inputLost && (now - lastValidPacket) >= CRSF_TIMEOUT_RADIO_MS ) {
-		inputLost = true;
-		countBadIL++;
-		idx = CRSF_INDEX_SYNC;
-	}
-}
-
-/*
- * CRSF_getDataPtr
- *  -
- */
-uint32_t* CRSF_getData ( void )
-{
-    return data;
-}
-
-/*
- * CRSF_getInputLost
- *  -
- */
-bool* CRSF_getInputLost ( void )
-{
-    return &inputLost;
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE FUNCTIONS                                 */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-static CRSF_frameType_e CRSF_Decode ( void )
-{
-	switch ( rx[CRSF_INDEX_PAYLOAD] ) {
-
-	case CRSF_FRAMETYPE_RC_CHANNELS:
-		CRSF_DecodeFrame_ChannelsRC();
-		return CRSF_FRAMETYPE_RC_CHANNELS;
-
-	case CRSF_FRAMETYPE_LINK_STATISTICS:
-		CRSF_DecodeFrame_LinkStats();
-		return CRSF_FRAMETYPE_LINK_STATISTICS;
-
-	case CRSF_FRAMETYPE_GPS:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_ATTITUDE:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_VARIO:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_BATTERY_SENSOR:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_BARO_ALTITUDE:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_OPENTX_SYNC:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_FLIGHT_MODE:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_PING_DEVICES:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_DEVICE_INFO:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_REQUEST_SETTINGS:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_COMMAND:
-		return CRSF_unknown;
-	case CRSF_FRAMETYPE_RADIO:
-		return CRSF_unknown;
-//	case CRSF_FRAMETYPE_GPS_TIME:
-//		return false;
-//	case CRSF_FRAMETYPE_GPS_EXT:
-//		return false;
-//	case CRSF_FRAMETYPE_AIRSPEED:
-//		return false;
-//	case CRSF_FRAMETYPE_HEARTBEAT:
-//		return false;
-//	case CRSF_FRAMETYPE_RPM:
-//		return false;
-//	case CRSF_FRAMETYPE_TEMP:
-//		return false;
-//	case CRSF_FRAMETYPE_VTX_TELEMETRY:
-//		return false;
-//	case CRSF_FRAMETYPE_SUBSET_RC_CHANNELS_PACKED:
-//		return false;
-//	case CRSF_FRAMETYPE_LINK_RX_ID:
-//		return false;
-//	case CRSF_FRAMETYPE_LINK_TX_ID:
-//		return false;
-//	case CRSF_FRAMETYPE_MAVLINK_FC:
-//		return false;
-//	case CRSF_FRAMETYPE_ESP_NOW_MSG:
-//		return false;
-	default:
-		return CRSF_unknown;
-	}
-
-	return CRSF_unknown;
-}
-
-/*
- *
- */
-static inline void CRSF_DecodeFrame_ChannelsRC ( void )
-{
-	// decode 16×11-bit channels from payload
-	for ( int i = 0; i < CRSF_CH_NUM; i++ ) {
-		uint32_t bitIndex = i * 11;
-		uint32_t byteIndex = (CRSF_INDEX_PAYLOAD + CRSF_LEN_TYPE) + (bitIndex >> 3); // divide by 8 and offset
-		uint32_t bitOffset = bitIndex & 7; // mod 8
-		// Extract the 16 channels
-		raw[i] = ( (rx[byteIndex] >> bitOffset) | (rx[byteIndex + 1] << (8 - bitOffset)) );
-		// If our 11-bit slice spans three bytes, grab the third byte too
-		if ( bitOffset > 5 ) {
-			raw[i] |= (uint32_t)rx[byteIndex + 2] << (16 - bitOffset) ;
-		}
-		// Mask to 11 bits, transform, and store
-		raw[i] &= 0x07FF;
-		uint32_t convert = raw[i];
-		// Bound data
-	    if 		( convert < (CRSF_MIN - CRSF_THRESHOLD) )	{ convert = 0; }
-	    else if ( convert <  CRSF_MIN_1000)                 { convert = CRSF_MIN_1000; }
-	    else if ( convert <= CRSF_MAX_2000)              	{ /* do nothing*/ }
-	    else if ( convert <= (CRSF_MAX + CRSF_THRESHOLD) )	{ convert = CRSF_MAX_2000; }
-	    else                                       			{ convert = 0; }
-		// transform
-		if ( convert ) {
-			convert -= CRSF_MIN_1000;
-			convert *= 1000;//RADIO_CH_FULLSCALE;
-			convert /= (CRSF_MAX_2000 - CRSF_MIN_1000);
-			convert += 1000;//RADIO_CH_MIN;
-		}
-	    // store
-		data[i] = convert;
-	}
-}
-
-
-static inline void CRSF_DecodeFrame_LinkStats ( void )
-{
-
-}
-
-/*
- * CRSF_CalcCRC8
- *  - CRC-8/D5 — initial 0, poly 0xD5, reflected = false
- */
-static uint8_t CRSF_CalcCRC8 ( const uint8_t *data, uint8_t len )
-{
-    uint8_t crc = 0;
-
-    for ( uint8_t i = 0; i < len; i++ )
-    {
-        crc ^= data[i];
-
-        for ( uint8_t b = 0; b < 8; b++ )
-        {
-            if ( crc & 0x80) {
-            	crc = (crc << 1) ^ 0xD5;
-            } else {
-                crc <<= 1;
-            }
-        }
-    }
-    return crc;
-}
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EVENT HANDLERS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* INTERRUPT ROUTINES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#endif
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "CRSF.h"
+#include "Radio.h"
+
+#ifdef RADIO_USE_CRSF
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS                               */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifdef RADIO_USE_CRSF
+#ifndef CRSF_UART
+#error "error: CRSF_UART needs to be defined (e.g UART_1)"
+#endif
+#ifndef UART1_PINS
+#error "error: UART1_PINS needs to be defined (e.g GPIO_PIN_7)"
+#endif
+#ifndef UART1_AF
+#error "error: UART1_AF needs to be defined (e.g GPIO_AF0_USART1)"
+#endif
+#endif
+
+#define CRSF_TICKS_TO_US(x)  ((x - 992) * 5 / 8 + 1500)
+#define CRSF_US_TO_TICKS(x)  ((x - 1500) * 8 / 5 + 992)
+
+#define CRSF_TIMEOUT_GAP_CHARS	8		// Silence mid packet that aborts it, in characters
+#define CRSF_TIMEOUT_SLACK_US	500		// Added to a packet's time on the wire before it is abandoned
+#define CRSF_TIMEOUT_RADIO_US	TIMEBASE_MS(100)	// Longest failsafe timeout, see TIMEBASE_TIMEOUT_FRAMES
+#define CRSF_CHAR_BITS			10		// 8N1
+
+#define CRSF_LEN_SYNC           1
+#define CRSF_LEN_LENGTH         1
+#define CRSF_LEN_TYPE       	1
+#define CRSF_LEN_CRC8       	1
+#define CRSF_LEN_PACKET_MIN     3
+
+#define CRSF_INDEX_SYNC         0
+#define CRSF_INDEX_LENGTH       1
+#define CRSF_INDEX_PAYLOAD      2
+
+#define CRSF_SYNC          		0xC8
+
+#define CRSF_LINKSTATS_LQ		2		// Uplink link quality (%) offset in LINK_STATISTICS payload
+#define CRSF_LEN_LINKSTATS		10		// LINK_STATISTICS payload
+
+// Channel transformation constants (calibration values)
+#define CRSF_MIN             	172
+#define CRSF_MIN_1000           191
+#define CRSF_CENTER				992
+#define CRSF_MAX_2000           1792
+#define CRSF_MAX                1811
+#define CRSF_THRESHOLD          10
+#define CRSF_RANGE              (CRSF_MAX - CRSF_MIN)
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES                                        */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES                                   */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifdef RADIO_PARSE_IN_IRQ
+static void 		CRSF_Parse					( CRSF_t *, uint8_t );
+#else
+#ifndef RADIO_RX_IN_IRQ
+static void 		CRSF_HandleUART				( CRSF_t * );
+#endif
+static void 		CRSF_ParseRing				( CRSF_t * );
+#endif
+static CRSF_frameType_e CRSF_Decode					( CRSF_t *, const uint8_t * );
+static inline void	CRSF_DecodeFrame_ChannelsRC	( CRSF_t *, const uint8_t * );
+static inline void 	CRSF_DecodeFrame_LinkStats 	( CRSF_t *, const uint8_t * );
+static uint32_t		CRSF_Unpack					( const uint8_t *, uint8_t );
+static void 		CRSF_Commit					( CRSF_t *, uint8_t, uint16_t );
+#ifdef RADIO_LAZY_DECODE
+static void 		CRSF_Flush					( CRSF_t * );
+#endif
+static uint32_t		CRSF_Transform				( uint32_t );
+static uint8_t 		CRSF_CRC8					( uint8_t, uint8_t );
+
+static bool 		CRSF_opsInit				( void *, uint32_t, bool );
+static void 		CRSF_opsDeinit				( void * );
+static bool 		CRSF_opsDetect				( void * );
+static void 		CRSF_opsUpdate				( void * );
+static uint16_t*	CRSF_opsGetData				( void * );
+#ifdef RADIO_LAZY_DECODE
+static void 		CRSF_opsSubscribe			( void *, uint32_t );
+#endif
+#ifdef RADIO_USE_HIRES
+static int16_t*	CRSF_opsGetNormalised	( void * );
+static uint16_t*	CRSF_opsGetRaw				( void * );
+#endif
+static uint32_t 		CRSF_opsGetInputLost		( void * );
+static uint32_t		CRSF_opsGetFrameCount		( void * );
+static uint32_t		CRSF_opsGetFrameTime		( void * );
+static uint8_t		CRSF_opsGetLinkQuality		( void * );
+static void 		CRSF_opsOnFrame				( void *, void (*)(void) );
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+static void 		CRSF_opsRxByte				( void *, uint8_t );
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES                                 */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Dispatch table for Radio.c, which keeps a CRSF_t per input */
+const RADIO_ops_t CRSF_ops = {
+	.chCount		= CRSF_CH_NUM,
+	.init			= CRSF_opsInit,
+	.deinit			= CRSF_opsDeinit,
+	.detect			= CRSF_opsDetect,
+	.update			= CRSF_opsUpdate,
+	.getData		= CRSF_opsGetData,
+#ifdef RADIO_LAZY_DECODE
+	.subscribe		= CRSF_opsSubscribe,
+#endif
+#ifdef RADIO_USE_HIRES
+	.getNormalised	= CRSF_opsGetNormalised,
+	.getRaw			= CRSF_opsGetRaw,
+#endif
+	.getInputLost	= CRSF_opsGetInputLost,
+	.getFrameCount	= CRSF_opsGetFrameCount,
+	.getLinkQuality	= CRSF_opsGetLinkQuality,
+	.getFrameTime	= CRSF_opsGetFrameTime,
+	.onFrame		= CRSF_opsOnFrame,
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+	.rxByte			= CRSF_opsRxByte,
+#endif
+};
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS                                  */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * CRSF_Init
+ *  - Binds the receiver to a UART and starts it. Clears any callback, so
+ *    CRSF_OnFrame() goes after this.
+ *  - baud: normally CRSF_BAUD, inverted: true if the line idles low
+ *  - Any number of receivers can run, each with its own CRSF_t and UART.
+ */
+void CRSF_Init ( CRSF_t * crsf, UART_t * uart, uint32_t baud, bool inverted )
+{
+    memset( crsf, 0, sizeof(*crsf) );
+    crsf->uart		= uart;
+#ifdef RADIO_PARSE_IN_IRQ
+    crsf->idx		= CRSF_INDEX_SYNC;
+#else
+    RING_Init( &crsf->ring, crsf->ringBuffer, sizeof(crsf->ringBuffer) );
+#endif
+    crsf->charUs	= TIMEBASE_CharUs( baud, CRSF_CHAR_BITS );
+    crsf->fill		= 1;
+    crsf->inputLost	= true;
+    TIMEBASE_RateInit( &crsf->rate, CRSF_TIMEOUT_RADIO_US );
+#ifdef RADIO_LAZY_DECODE
+    crsf->subscribed	= RADIO_CH_MASK(CRSF_CH_NUM);
+#endif
+
+    UART_Init(		uart, baud, inverted ? UART_Mode_Inverted : UART_Mode_Default );
+    UART_ReadFlush( uart );
+}
+
+/*
+ * CRSF_Deinit
+ *  -
+ */
+void CRSF_Deinit ( CRSF_t * crsf )
+{
+    UART_Deinit( crsf->uart );
+}
+
+/*
+ * CRSF_Detect
+ *  - Non-blocking. Call after CRSF_Update() during detection.
+ *  - Returns true once valid RC frames are being received.
+ */
+bool CRSF_Detect ( CRSF_t * crsf )
+{
+    return !crsf->inputLost;
+}
+
+/*
+ * CRSF_Update
+ *  - Parses buffered bytes, then takes the last complete frame.
+ *  - With RADIO_PARSE_IN_IRQ the bytes were already parsed by CRSF_RX_IRQ().
+ */
+void CRSF_Update ( CRSF_t * crsf )
+{
+#ifndef RADIO_PARSE_IN_IRQ
+#ifndef RADIO_RX_IN_IRQ
+	CRSF_HandleUART( crsf );
+#endif
+	CRSF_ParseRing( crsf );
+#endif
+
+	uint32_t seq = crsf->rxSeq;
+
+	// NEW RC FRAME
+	if ( seq != crsf->frameCount ) {
+		// Copy the published frame. If the parser publishes again mid copy the
+		// buffer may be reused, so repeat with the newer frame.
+		do {
+			seq = crsf->rxSeq;
+			uint8_t ready = crsf->rxReady;
+#ifdef RADIO_LAZY_DECODE
+			// Only the packed bytes, channels are unpacked when first read
+			for ( uint8_t i = 0; i < CRSF_LEN_CHANNELS; i++ ) {
+				crsf->packed[i] = crsf->rxPacked[ready][i];
+			}
+#else
+			for ( uint8_t i = 0; i < CRSF_CH_NUM; i++ ) {
+				CRSF_Commit( crsf, i, crsf->rxCh[ready][i] );
+			}
+#endif
+			crsf->frameTime = crsf->rxTime[ready];
+		} while ( seq != crsf->rxSeq );
+#ifdef RADIO_LAZY_DECODE
+		crsf->dirty = crsf->subscribed;
+#endif
+
+		TIMEBASE_RateFrame( &crsf->rate, crsf->frameTime, seq - crsf->frameCount );
+		crsf->inputLost = false;
+		crsf->frameCount = seq;
+#ifndef RADIO_PARSE_IN_IRQ
+		if ( crsf->onFrame != NULL ) { crsf->onFrame(); }
+#endif
+	}
+
+	// TIMEOUT WITH RADIO
+	if ( !crsf->inputLost && TIMEBASE_Elapsed(crsf->frameTime, TIMEBASE_RateTimeout(&crsf->rate)) ) {
+		crsf->inputLost = true;
+	}
+}
+
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+/*
+ * CRSF_RX_IRQ
+ *  - Call from the receive interrupt of the receiver's UART with each byte received.
+ *  - RADIO_RX_IN_IRQ queues the byte for CRSF_Update(). It is dropped if the ring is full.
+ *  - RADIO_PARSE_IN_IRQ parses it straight away at a bounded cost per byte. The CRC is
+ *    accumulated as bytes arrive, so the last byte of a frame only adds the channel unpack.
+ */
+void CRSF_RX_IRQ ( CRSF_t * crsf, uint8_t byte )
+{
+#ifdef RADIO_PARSE_IN_IRQ
+	CRSF_Parse( crsf, byte );
+#else
+	RING_Put( &crsf->ring, byte );
+#endif
+}
+#endif
+
+/*
+ * CRSF_getDataPtr
+ *  -
+ */
+uint16_t* CRSF_getData ( CRSF_t * crsf )
+{
+#ifdef RADIO_LAZY_DECODE
+	CRSF_Flush( crsf );
+#endif
+    return crsf->data;
+}
+
+/*
+ * CRSF_getChannel
+ *  - One channel (us) of the last frame. With RADIO_LAZY_DECODE only this channel is unpacked.
+ */
+uint16_t CRSF_getChannel ( CRSF_t * crsf, uint8_t c )
+{
+	if ( c >= CRSF_CH_NUM ) { return 0; }
+
+#ifdef RADIO_LAZY_DECODE
+	if ( crsf->dirty & (1UL << c) ) {
+		crsf->dirty &= ~(1UL << c);
+		CRSF_Commit( crsf, c, CRSF_Unpack( crsf->packed, c ) );
+	}
+#endif
+	return crsf->data[c];
+}
+
+#ifdef RADIO_LAZY_DECODE
+/*
+ * CRSF_Subscribe
+ *  - Channels to unpack from each frame, bit per channel. The others keep their last value.
+ *  - Takes effect from the current frame.
+ */
+void CRSF_Subscribe ( CRSF_t * crsf, uint32_t mask )
+{
+	crsf->subscribed = mask & RADIO_CH_MASK(CRSF_CH_NUM);
+	crsf->dirty &= crsf->subscribed;
+}
+#endif
+
+#ifdef RADIO_USE_HIRES
+/*
+ * CRSF_getNormalised
+ *  - Channels as Q15 (+-32767 for 1000-2000us) at the full 11 bit resolution of the link.
+ */
+int16_t* CRSF_getNormalised ( CRSF_t * crsf )
+{
+#ifdef RADIO_LAZY_DECODE
+	CRSF_Flush( crsf );
+#endif
+	return crsf->norm;
+}
+
+/*
+ * CRSF_getRaw
+ *  - Channel values as received, before bounding and scaling.
+ */
+uint16_t* CRSF_getRaw ( CRSF_t * crsf )
+{
+#ifdef RADIO_LAZY_DECODE
+	CRSF_Flush( crsf );
+#endif
+	return crsf->raw;
+}
+#endif
+
+/*
+ * CRSF_getInputLost
+ *  - Bit per channel, all set while the link is lost.
+ */
+uint32_t CRSF_getInputLost ( CRSF_t * crsf )
+{
+    return crsf->inputLost ? RADIO_CH_MASK(CRSF_CH_NUM) : 0;
+}
+
+/*
+ * CRSF_getFrameCount
+ *  - Incremented for every valid RC channels frame. Wraps.
+ */
+uint32_t CRSF_getFrameCount ( CRSF_t * crsf )
+{
+    return crsf->frameCount;
+}
+
+/*
+ * CRSF_getFrameTime
+ *  - US_Read() timestamp of the last RC channels frame, taken when its last byte was parsed.
+ */
+uint32_t CRSF_getFrameTime ( CRSF_t * crsf )
+{
+	return crsf->frameTime;
+}
+
+/*
+ * CRSF_getLinkQuality
+ *  - Uplink LQ (%) from LINK_STATISTICS frames. 100 while receiving if the
+ *    receiver does not send link statistics.
+ */
+uint8_t CRSF_getLinkQuality ( CRSF_t * crsf )
+{
+	if ( crsf->inputLost ) { return 0; }
+
+    return crsf->linkStats ? crsf->linkQuality : 100;
+}
+
+/*
+ * CRSF_OnFrame
+ *  - Registers a callback fired from CRSF_Update() as soon as a valid frame is committed.
+ *  - With RADIO_PARSE_IN_IRQ it is fired from CRSF_RX_IRQ() instead.
+ *  - Pass NULL to remove.
+ */
+void CRSF_OnFrame ( CRSF_t * crsf, void (*callback)(void) )
+{
+	crsf->onFrame = callback;
+}
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS                                 */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifdef RADIO_PARSE_IN_IRQ
+/*
+ * CRSF_Parse
+ *  - Advances the frame state machine by one byte.
+ */
+static void CRSF_Parse ( CRSF_t * crsf, uint8_t byte )
+{
+	// Bytes arrive as they are received, so a gap this long means the frame was cut short
+	uint32_t now = TIMEBASE_Now();
+	if ( crsf->idx != CRSF_INDEX_SYNC && (now - crsf->lastByte) >= crsf->charUs * CRSF_TIMEOUT_GAP_CHARS ) {
+		crsf->idx = CRSF_INDEX_SYNC;
+	}
+	crsf->lastByte = now;
+
+    // LOOKING FOR PROTOCOL SYNC BYTE
+    if ( crsf->idx == CRSF_INDEX_SYNC ) {
+		// Confirm data is CRSF sync byte
+		if ( byte == CRSF_SYNC ) {
+			crsf->rx[CRSF_INDEX_SYNC]	= byte;
+			crsf->idx = CRSF_INDEX_LENGTH;
+		}
+	}
+
+    // LOOK FOR VALID PROTOCOL LENGTH BYTE
+    else if ( crsf->idx == CRSF_INDEX_LENGTH ) {
+    	// Confirm valid packet length
+    	if ( byte >= CRSF_LEN_PACKET_MIN && byte <= (CRSF_LEN_PACKET_MAX - CRSF_LEN_SYNC - CRSF_LEN_CRC8) ) {
+        	crsf->rx[CRSF_INDEX_LENGTH] = byte;
+        	crsf->payloadLen = CRSF_LEN_SYNC + CRSF_LEN_LENGTH + crsf->rx[CRSF_INDEX_LENGTH];
+        	crsf->crc = 0;
+        	crsf->idx = CRSF_INDEX_PAYLOAD;
+        // Failed check
+    	} else {
+    		crsf->idx = CRSF_INDEX_SYNC;
+    	}
+    }
+
+    // WAIT TO READ IN FULL PAYLOAD
+    else {
+    	crsf->rx[crsf->idx] = byte;
+
+    	// Check for complete payload Rx
+    	if ( crsf->idx >= (crsf->payloadLen-1) )
+    	{
+    		// Verify Payload against the running checksum
+     		if ( crsf->crc == byte ) {
+     			CRSF_Decode( crsf, crsf->rx );
+    		}
+    		crsf->idx = CRSF_INDEX_SYNC;
+    	}
+    	else {
+    		crsf->crc = CRSF_CRC8( crsf->crc, byte );
+    		crsf->idx++;
+    	}
+    }
+}
+#else
+#ifndef RADIO_RX_IN_IRQ
+/*
+ * CRSF_HandleUART
+ *  - Moves everything the UART driver has buffered into the ring, one block read
+ *    per contiguous span.
+ */
+static void CRSF_HandleUART ( CRSF_t * crsf )
+{
+	uint32_t count = UART_ReadCount( crsf->uart );
+
+	while ( count ) {
+		uint8_t * span;
+		uint32_t n = RING_WriteSpan( &crsf->ring, &span );
+		if ( n == 0 ) { break; }
+		if ( n > count ) { n = count; }
+
+		UART_Read( crsf->uart, span, n );
+		RING_Write( &crsf->ring, n );
+		count -= n;
+	}
+}
+#endif
+
+/*
+ * CRSF_ParseRing
+ *  - Validates packets in place at the front of the ring. A packet is consumed whole
+ *    once its CRC checks out, otherwise the ring moves on one byte to resynchronise.
+ */
+static void CRSF_ParseRing ( CRSF_t * crsf )
+{
+	uint32_t count;
+
+	while ( (count = RING_Count(&crsf->ring)) >= CRSF_LEN_SYNC + CRSF_LEN_LENGTH )
+	{
+		// LOOK FOR PROTOCOL SYNC AND VALID LENGTH BYTES
+		uint8_t len = RING_Peek( &crsf->ring, CRSF_INDEX_LENGTH );
+		if ( RING_Peek(&crsf->ring, CRSF_INDEX_SYNC) != CRSF_SYNC
+		 || len < CRSF_LEN_PACKET_MIN || len > (CRSF_LEN_PACKET_MAX - CRSF_LEN_SYNC - CRSF_LEN_CRC8) ) {
+			RING_Skip( &crsf->ring, 1 );
+			crsf->pending = false;
+			continue;
+		}
+
+		// WAIT TO READ IN FULL PAYLOAD, ABORT IF IT TIMES OUT
+		uint8_t packetLen = CRSF_LEN_SYNC + CRSF_LEN_LENGTH + len;
+		if ( count < packetLen ) {
+			if ( !crsf->pending ) {
+				crsf->pending = true;
+				crsf->packetStart = TIMEBASE_Now();
+			} else if ( TIMEBASE_Elapsed(crsf->packetStart, packetLen * crsf->charUs + CRSF_TIMEOUT_SLACK_US) ) {
+				RING_Skip( &crsf->ring, 1 );
+				crsf->pending = false;
+				continue;
+			}
+			break;
+		}
+		crsf->pending = false;
+
+		// Verify Payload
+		uint8_t crc = 0;
+		for ( uint8_t i = CRSF_INDEX_PAYLOAD; i < packetLen - CRSF_LEN_CRC8; i++ ) {
+			crc = CRSF_CRC8( crc, RING_Peek(&crsf->ring, i) );
+		}
+		if ( crc != RING_Peek(&crsf->ring, packetLen - CRSF_LEN_CRC8) ) {
+			RING_Skip( &crsf->ring, 1 );
+			continue;
+		}
+
+		CRSF_Decode( crsf, RING_Linearise(&crsf->ring, crsf->rx, packetLen) );
+		RING_Skip( &crsf->ring, packetLen );
+	}
+}
+#endif
+
+/*
+ * CRSF_Decode
+ *  - Both parsers pass every packet whose CRC checks out. The decoders read their whole
+ *    payload, so its length is checked per type first: the ring parser hands out packets
+ *    in place, and a short one would be read past.
+ */
+static CRSF_frameType_e CRSF_Decode ( CRSF_t * crsf, const uint8_t * frame )
+{
+	uint8_t len = frame[CRSF_INDEX_LENGTH];
+
+	switch ( frame[CRSF_INDEX_PAYLOAD] ) {
+
+	case CRSF_FRAMETYPE_RC_CHANNELS:
+		if ( len != CRSF_LEN_TYPE + CRSF_LEN_CHANNELS + CRSF_LEN_CRC8 ) { return CRSF_unknown; }
+		CRSF_DecodeFrame_ChannelsRC( crsf, frame );
+		return CRSF_FRAMETYPE_RC_CHANNELS;
+
+	case CRSF_FRAMETYPE_LINK_STATISTICS:
+		if ( len < CRSF_LEN_TYPE + CRSF_LEN_LINKSTATS + CRSF_LEN_CRC8 ) { return CRSF_unknown; }
+		CRSF_DecodeFrame_LinkStats( crsf, frame );
+		return CRSF_FRAMETYPE_LINK_STATISTICS;
+
+	case CRSF_FRAMETYPE_GPS:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_ATTITUDE:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_VARIO:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_BATTERY_SENSOR:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_BARO_ALTITUDE:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_OPENTX_SYNC:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_FLIGHT_MODE:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_PING_DEVICES:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_DEVICE_INFO:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_REQUEST_SETTINGS:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_COMMAND:
+		return CRSF_unknown;
+	case CRSF_FRAMETYPE_RADIO:
+		return CRSF_unknown;
+//	case CRSF_FRAMETYPE_GPS_TIME:
+//		return false;
+//	case CRSF_FRAMETYPE_GPS_EXT:
+//		return false;
+//	case CRSF_FRAMETYPE_AIRSPEED:
+//		return false;
+//	case CRSF_FRAMETYPE_HEARTBEAT:
+//		return false;
+//	case CRSF_FRAMETYPE_RPM:
+//		return false;
+//	case CRSF_FRAMETYPE_TEMP:
+//		return false;
+//	case CRSF_FRAMETYPE_VTX_TELEMETRY:
+//		return false;
+//	case CRSF_FRAMETYPE_SUBSET_RC_CHANNELS_PACKED:
+//		return false;
+//	case CRSF_FRAMETYPE_LINK_RX_ID:
+//		return false;
+//	case CRSF_FRAMETYPE_LINK_TX_ID:
+//		return false;
+//	case CRSF_FRAMETYPE_MAVLINK_FC:
+//		return false;
+//	case CRSF_FRAMETYPE_ESP_NOW_MSG:
+//		return false;
+	default:
+		return CRSF_unknown;
+	}
+
+	return CRSF_unknown;
+}
+
+/*
+ * CRSF_DecodeFrame_ChannelsRC
+ *  - Unpacks the 16x 11-bit channels into the fill buffer and publishes it.
+ *  - With RADIO_LAZY_DECODE the packed bytes are published as they are.
+ */
+static inline void CRSF_DecodeFrame_ChannelsRC ( CRSF_t * crsf, const uint8_t * frame )
+{
+	const uint8_t * packed = &frame[CRSF_INDEX_PAYLOAD + CRSF_LEN_TYPE];
+#ifdef RADIO_LAZY_DECODE
+	for ( uint8_t i = 0; i < CRSF_LEN_CHANNELS; i++ ) {
+		crsf->rxPacked[crsf->fill][i] = packed[i];
+	}
+#else
+	for ( uint8_t i = 0; i < CRSF_CH_NUM; i++ ) {
+		crsf->rxCh[crsf->fill][i] = CRSF_Unpack( packed, i );
+	}
+#endif
+
+	// Publish the frame and fill the other buffer next
+	crsf->rxTime[crsf->fill] = US_Read();
+	crsf->rxReady = crsf->fill;
+	crsf->fill ^= 1;
+	crsf->rxSeq++;
+
+#ifdef RADIO_PARSE_IN_IRQ
+	if ( crsf->onFrame != NULL ) { crsf->onFrame(); }
+#endif
+}
+
+static inline void CRSF_DecodeFrame_LinkStats ( CRSF_t * crsf, const uint8_t * frame )
+{
+	crsf->linkQuality = frame[CRSF_INDEX_PAYLOAD + CRSF_LEN_TYPE + CRSF_LINKSTATS_LQ];
+	crsf->linkStats = true;
+}
+
+/*
+ * CRSF_Unpack
+ *  - Extracts channel c from the 11-bit packed channel bytes.
+ */
+static uint32_t CRSF_Unpack ( const uint8_t * packed, uint8_t c )
+{
+	uint32_t bitIndex = c * 11;
+	uint32_t byteIndex = bitIndex >> 3; // divide by 8
+	uint32_t bitOffset = bitIndex & 7; // mod 8
+	uint32_t raw = ( (packed[byteIndex] >> bitOffset) | (packed[byteIndex + 1] << (8 - bitOffset)) );
+	// If our 11-bit slice spans three bytes, grab the third byte too
+	if ( bitOffset > 5 ) {
+		raw |= (uint32_t)packed[byteIndex + 2] << (16 - bitOffset) ;
+	}
+	// Mask to 11 bits
+	return raw & 0x07FF;
+}
+
+/*
+ * CRSF_Commit
+ *  - Stores channel c of the last frame from its raw value.
+ */
+static void CRSF_Commit ( CRSF_t * crsf, uint8_t c, uint16_t raw )
+{
+	crsf->data[c] = CRSF_Transform( raw );
+#ifdef RADIO_USE_HIRES
+	// Same bounds as the microseconds, without their rounding
+	uint16_t bounded = RADIO_MAX( RADIO_MIN( raw, CRSF_MAX_2000 ), CRSF_MIN_1000 );
+	crsf->raw[c]  = raw;
+	crsf->norm[c] = crsf->data[c] ? RADIO_Q15( bounded, CRSF_MIN_1000, CRSF_MAX_2000 ) : 0;
+#endif
+}
+
+#ifdef RADIO_LAZY_DECODE
+/*
+ * CRSF_Flush
+ *  - Unpacks every subscribed channel not yet read from the last frame.
+ */
+static void CRSF_Flush ( CRSF_t * crsf )
+{
+	uint32_t dirty = crsf->dirty;
+	crsf->dirty = 0;
+	for ( uint8_t c = 0; dirty; c++, dirty >>= 1 ) {
+		if ( dirty & 1 ) {
+			CRSF_Commit( crsf, c, CRSF_Unpack( crsf->packed, c ) );
+		}
+	}
+}
+#endif
+
+/*
+ * CRSF_Transform
+ *  - Bounds a raw channel and scales it to 1000-2000us. 0 if out of range.
+ */
+static uint32_t CRSF_Transform ( uint32_t convert )
+{
+	// Bound data
+    if 		( convert < (CRSF_MIN - CRSF_THRESHOLD) )	{ convert = 0; }
+    else if ( convert <  CRSF_MIN_1000)                 { convert = CRSF_MIN_1000; }
+    else if ( convert <= CRSF_MAX_2000)              	{ /* do nothing*/ }
+    else if ( convert <= (CRSF_MAX + CRSF_THRESHOLD) )	{ convert = CRSF_MAX_2000; }
+    else                                       			{ convert = 0; }
+	// transform
+	if ( convert ) {
+		convert -= CRSF_MIN_1000;
+		convert *= 1000;//RADIO_CH_FULLSCALE;
+		convert /= (CRSF_MAX_2000 - CRSF_MIN_1000);
+		convert += 1000;//RADIO_CH_MIN;
+	}
+	return convert;
+}
+
+/*
+ * CRSF_CRC8
+ *  - CRC-8/D5 — initial 0, poly 0xD5, reflected = false
+ *  - Adds one byte to a running crc.
+ */
+static uint8_t CRSF_CRC8 ( uint8_t crc, uint8_t byte )
+{
+    crc ^= byte;
+
+    for ( uint8_t b = 0; b < 8; b++ )
+    {
+        if ( crc & 0x80) {
+        	crc = (crc << 1) ^ 0xD5;
+        } else {
+            crc <<= 1;
+        }
+    }
+    return crc;
+}
+
+/*
+ * CRSF_ops entries
+ *  - ctx is the CRSF_t of the Radio.c input, which is bound to CRSF_UART.
+ */
+static bool CRSF_opsInit ( void * ctx, uint32_t baud, bool inverted )
+{
+	CRSF_Init( ctx, CRSF_UART, baud, inverted );
+	return true;
+}
+
+static void CRSF_opsDeinit ( void * ctx )
+{
+	CRSF_Deinit( ctx );
+}
+
+static bool CRSF_opsDetect ( void * ctx )
+{
+	return CRSF_Detect( ctx );
+}
+
+static void CRSF_opsUpdate ( void * ctx )
+{
+	CRSF_Update( ctx );
+}
+
+static uint16_t* CRSF_opsGetData ( void * ctx )
+{
+	return CRSF_getData( ctx );
+}
+
+#ifdef RADIO_LAZY_DECODE
+static void CRSF_opsSubscribe ( void * ctx, uint32_t mask )
+{
+	CRSF_Subscribe( ctx, mask );
+}
+#endif
+
+#ifdef RADIO_USE_HIRES
+static int16_t* CRSF_opsGetNormalised ( void * ctx )
+{
+	return CRSF_getNormalised( ctx );
+}
+
+static uint16_t* CRSF_opsGetRaw ( void * ctx )
+{
+	return CRSF_getRaw( ctx );
+}
+#endif
+
+static uint32_t CRSF_opsGetInputLost ( void * ctx )
+{
+	return CRSF_getInputLost( ctx );
+}
+
+static uint32_t CRSF_opsGetFrameCount ( void * ctx )
+{
+	return CRSF_getFrameCount( ctx );
+}
+
+static uint32_t CRSF_opsGetFrameTime ( void * ctx )
+{
+	return CRSF_getFrameTime( ctx );
+}
+
+static uint8_t CRSF_opsGetLinkQuality ( void * ctx )
+{
+	return CRSF_getLinkQuality( ctx );
+}
+
+static void CRSF_opsOnFrame ( void * ctx, void (*callback)(void) )
+{
+	CRSF_OnFrame( ctx, callback );
+}
+
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+static void CRSF_opsRxByte ( void * ctx, uint8_t byte )
+{
+	CRSF_RX_IRQ( ctx, byte );
+}
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
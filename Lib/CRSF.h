@@ -1,71 +1,148 @@
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#ifndef CRSF_H
-#define CRSF_H
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#include "STM32X.h"
-
-#include "UART.h"
-#include "Core.h"
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#define CRSF_CH_NUM	16
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC TYPES      									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-typedef enum
-{
-	CRSF_unknown = 0x00,
-    CRSF_FRAMETYPE_GPS = 0x02,
-//    CRSF_FRAMETYPE_GPS_TIME = 0x03,
-//    CRSF_FRAMETYPE_GPS_EXT = 0x06,
-    CRSF_FRAMETYPE_VARIO = 0x07,
-    CRSF_FRAMETYPE_BATTERY_SENSOR = 0x08,
-    CRSF_FRAMETYPE_BARO_ALTITUDE = 0x09,
-    CRSF_FRAMETYPE_OPENTX_SYNC = 0x10,
-//    CRSF_FRAMETYPE_AIRSPEED = 0x0A,
-//    CRSF_FRAMETYPE_HEARTBEAT = 0x0B,
-//    CRSF_FRAMETYPE_RPM = 0x0C,
-//    CRSF_FRAMETYPE_TEMP = 0x0D,
-//    CRSF_FRAMETYPE_VTX_TELEMETRY = 0x10,
-    CRSF_FRAMETYPE_LINK_STATISTICS = 0x14,
-    CRSF_FRAMETYPE_RC_CHANNELS = 0x16,
-//    CRSF_FRAMETYPE_SUBSET_RC_CHANNELS_PACKED = 0x17,
-//    CRSF_FRAMETYPE_LINK_RX_ID = 0x1C,
-//    CRSF_FRAMETYPE_LINK_TX_ID = 0x1D,
-    CRSF_FRAMETYPE_ATTITUDE = 0x1E,
-//    CRSF_FRAMETYPE_MAVLINK_FC = 0x1F,
-    CRSF_FRAMETYPE_FLIGHT_MODE = 0x21,
-//    CRSF_FRAMETYPE_ESP_NOW_MSG = 0x22,
-    CRSF_FRAMETYPE_PING_DEVICES = 0x28,
-    CRSF_FRAMETYPE_DEVICE_INFO = 0x29,
-    CRSF_FRAMETYPE_REQUEST_SETTINGS = 0x2A,
-    CRSF_FRAMETYPE_COMMAND = 0x32,
-    CRSF_FRAMETYPE_RADIO = 0x3A,
-} CRSF_frameType_e;
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-void 		CRSF_Init 			( void );
-void 		CRSF_Deinit 		( void );
-bool 		CRSF_Detect 		( void );
-void 		CRSF_Update 		( void );
-
-uint32_t*	CRSF_getData		( void );
-bool* 		CRSF_getInputLost	( void );
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EXTERN DECLARATIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#endif /* CRSF_H */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef CRSF_H
+#define CRSF_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+#include "UART.h"
+#include "Core.h"
+#include "US.h"
+#include "Ring.h"
+#include "Timebase.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#define CRSF_CH_NUM	16
+
+#define CRSF_BAUD		420000
+#define CRSF_PERIOD_MS	4
+
+#define CRSF_DETECT_MS	100		// How long (ms) to listen for RC frames during detection
+
+#define CRSF_LEN_PACKET_MAX		64
+#define CRSF_LEN_CHANNELS		22		// 16x 11-bit channels, packed LSB first
+#define CRSF_RING_SIZE			128		// Serial ring, power of two and at least two packets
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef enum
+{
+	CRSF_unknown = 0x00,
+    CRSF_FRAMETYPE_GPS = 0x02,
+//    CRSF_FRAMETYPE_GPS_TIME = 0x03,
+//    CRSF_FRAMETYPE_GPS_EXT = 0x06,
+    CRSF_FRAMETYPE_VARIO = 0x07,
+    CRSF_FRAMETYPE_BATTERY_SENSOR = 0x08,
+    CRSF_FRAMETYPE_BARO_ALTITUDE = 0x09,
+    CRSF_FRAMETYPE_OPENTX_SYNC = 0x10,
+//    CRSF_FRAMETYPE_AIRSPEED = 0x0A,
+//    CRSF_FRAMETYPE_HEARTBEAT = 0x0B,
+//    CRSF_FRAMETYPE_RPM = 0x0C,
+//    CRSF_FRAMETYPE_TEMP = 0x0D,
+//    CRSF_FRAMETYPE_VTX_TELEMETRY = 0x10,
+    CRSF_FRAMETYPE_LINK_STATISTICS = 0x14,
+    CRSF_FRAMETYPE_RC_CHANNELS = 0x16,
+//    CRSF_FRAMETYPE_SUBSET_RC_CHANNELS_PACKED = 0x17,
+//    CRSF_FRAMETYPE_LINK_RX_ID = 0x1C,
+//    CRSF_FRAMETYPE_LINK_TX_ID = 0x1D,
+    CRSF_FRAMETYPE_ATTITUDE = 0x1E,
+//    CRSF_FRAMETYPE_MAVLINK_FC = 0x1F,
+    CRSF_FRAMETYPE_FLIGHT_MODE = 0x21,
+//    CRSF_FRAMETYPE_ESP_NOW_MSG = 0x22,
+    CRSF_FRAMETYPE_PING_DEVICES = 0x28,
+    CRSF_FRAMETYPE_DEVICE_INFO = 0x29,
+    CRSF_FRAMETYPE_REQUEST_SETTINGS = 0x2A,
+    CRSF_FRAMETYPE_COMMAND = 0x32,
+    CRSF_FRAMETYPE_RADIO = 0x3A,
+} CRSF_frameType_e;
+
+/* One CRSF receiver, bound to a UART by CRSF_Init(). Only the CRSF_* functions touch it */
+typedef struct {
+	UART_t *			uart;
+	uint32_t			charUs;					// One character at the configured baud
+#ifdef RADIO_PARSE_IN_IRQ
+	// Parser state - owned by CRSF_Parse(), which runs in the RX interrupt
+	uint32_t			idx;
+	uint8_t 			payloadLen;
+	uint8_t 			crc;
+	uint32_t			lastByte;
+#else
+	// Bytes waiting to be parsed, from CRSF_RX_IRQ() or drained from the UART driver
+	uint8_t				ringBuffer[CRSF_RING_SIZE];
+	RING_t				ring;
+	bool 				pending;				// Partial packet at the front of the ring
+	uint32_t			packetStart;			// When the partial packet was first seen
+#endif
+	uint8_t 			rx[CRSF_LEN_PACKET_MAX];
+
+	// Double buffer - the parser fills one while the other holds the last complete frame
+#ifdef RADIO_LAZY_DECODE
+	volatile uint8_t	rxPacked[2][CRSF_LEN_CHANNELS];	// Channel bytes as received, unpacked on first read
+#else
+	volatile uint16_t	rxCh[2][CRSF_CH_NUM];
+#endif
+	volatile uint8_t	rxReady;				// Buffer holding the last complete frame
+	volatile uint32_t	rxSeq;					// Incremented by the parser for each complete frame
+	volatile uint32_t	rxTime[2];				// US_Read() at the last byte of each buffer's frame
+	uint8_t 			fill;					// Buffer being filled, never rxReady
+
+	uint16_t			data[CRSF_CH_NUM];
+#ifdef RADIO_LAZY_DECODE
+	uint8_t				packed[CRSF_LEN_CHANNELS];	// Channel bytes of the last committed frame
+	uint32_t			dirty;					// Channels of packed not yet unpacked into data
+	uint32_t			subscribed;				// Channels unpacked at all, all by default
+#endif
+#ifdef RADIO_USE_HIRES
+	uint16_t			raw[CRSF_CH_NUM];		// Channel values as received
+	int16_t				norm[CRSF_CH_NUM];		// Q15 of the raw values, 0 where data is 0
+#endif
+	bool 				inputLost;
+	uint32_t			frameCount;
+	uint32_t			frameTime;
+	TIMEBASE_rate_t		rate;					// Frame rate, sets the failsafe timeout
+	volatile uint8_t	linkQuality;
+	volatile bool 		linkStats;
+	void 				( *onFrame )( void );
+} CRSF_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void 		CRSF_Init 			( CRSF_t *, UART_t *, uint32_t, bool );
+void 		CRSF_Deinit 		( CRSF_t * );
+bool 		CRSF_Detect 		( CRSF_t * );
+void 		CRSF_Update 		( CRSF_t * );
+
+uint16_t*	CRSF_getData		( CRSF_t * );
+uint16_t	CRSF_getChannel		( CRSF_t *, uint8_t );
+#ifdef RADIO_LAZY_DECODE
+void 		CRSF_Subscribe		( CRSF_t *, uint32_t );
+#endif
+#ifdef RADIO_USE_HIRES
+int16_t*	CRSF_getNormalised	( CRSF_t * );
+uint16_t*	CRSF_getRaw			( CRSF_t * );
+#endif
+uint32_t	CRSF_getInputLost	( CRSF_t * );
+uint32_t	CRSF_getFrameCount	( CRSF_t * );
+uint32_t	CRSF_getFrameTime	( CRSF_t * );
+uint8_t		CRSF_getLinkQuality	( CRSF_t * );
+void 		CRSF_OnFrame		( CRSF_t *, void (*)(void) );
+
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+void 		CRSF_RX_IRQ			( CRSF_t *, uint8_t );
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* CRSF_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
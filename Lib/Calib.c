@@ -0,0 +1,212 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Calib.h"
+#include "Radio.h"
+
+#ifdef RADIO_USE_CALIBRATION
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#define CALIB_CHECK				0x5A
+#define CALIB_UNSEEN			0xFFFF
+
+#if ((RADIO_CH_HALFSCALE << CALIB_GAIN_SHIFT) / CALIB_HALFSPAN_MIN) > 0xFFFF
+#error "error: CALIB_HALFSPAN_MIN too small for a 16 bit gain"
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static uint8_t	CALIB_Check		( const CALIB_record_t * );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * CALIB_Init
+ *  - Every channel passes through until a record is loaded or learned.
+ */
+void CALIB_Init ( CALIB_t * cal )
+{
+	memset( cal, 0, sizeof(*cal) );
+}
+
+/*
+ * CALIB_Load
+ *  - Compiles a stored record into the channel maps.
+ *  - Returns false, leaving every channel passing through, if the record is not valid.
+ */
+bool CALIB_Load ( CALIB_t * cal, const CALIB_record_t * rec )
+{
+	memset( cal->map, 0, sizeof(cal->map) );
+
+	if ( rec->chCount > CALIB_CH_NUM || rec->check != CALIB_Check(rec) ) { return false; }
+	cal->source = rec->source;
+
+	for ( uint8_t c = 0; c < rec->chCount; c++ )
+	{
+		uint16_t center = rec->center[c];
+		if ( center == 0 ) { continue; }
+
+		int32_t low  = (int32_t)center - rec->min[c];
+		int32_t high = (int32_t)rec->max[c] - center;
+		if ( low < CALIB_HALFSPAN_MIN || high < CALIB_HALFSPAN_MIN ) { continue; }
+
+		cal->map[c].center	 = center;
+		cal->map[c].gainLow	 = (RADIO_CH_HALFSCALE << CALIB_GAIN_SHIFT) / low;
+		cal->map[c].gainHigh = (RADIO_CH_HALFSCALE << CALIB_GAIN_SHIFT) / high;
+	}
+	return true;
+}
+
+/*
+ * CALIB_Start
+ *  - Starts learning. The current maps stay in use until CALIB_Finish().
+ */
+void CALIB_Start ( CALIB_t * cal )
+{
+	memset( &cal->learn, 0, sizeof(cal->learn) );
+	memset( cal->learn.min, 0xFF, sizeof(cal->learn.min) );
+	cal->learning = true;
+}
+
+/*
+ * CALIB_Sample
+ *  - Feeds one frame of decoded channels (microseconds) from source to the learning.
+ *    Lost channels are skipped. A frame from another source than the last starts over.
+ */
+void CALIB_Sample ( CALIB_t * cal, uint8_t source, const uint16_t * ch, uint8_t count, uint32_t lost )
+{
+	CALIB_record_t * l = &cal->learn;
+	if ( l->chCount != 0 && l->source != source ) {
+		CALIB_Start( cal );
+	}
+	l->source = source;
+
+	count = RADIO_MIN( count, CALIB_CH_NUM );
+	l->chCount = RADIO_MAX( l->chCount, count );
+
+	for ( uint8_t c = 0; c < count; c++ ) {
+		if ( ((lost >> c) & 1) || ch[c] == 0 ) { continue; }
+
+		l->min[c]	 = RADIO_MIN( l->min[c], ch[c] );
+		l->max[c]	 = RADIO_MAX( l->max[c], ch[c] );
+		l->center[c] = ch[c];
+	}
+}
+
+/*
+ * CALIB_Finish
+ *  - Ends learning and compiles the learned points. rec (optional) receives them for storage.
+ *  - Returns false if not learning.
+ */
+bool CALIB_Finish ( CALIB_t * cal, CALIB_record_t * rec )
+{
+	if ( !cal->learning ) { return false; }
+	cal->learning = false;
+
+	CALIB_record_t * l = &cal->learn;
+	for ( uint8_t c = 0; c < l->chCount; c++ )
+	{
+		if ( l->min[c] == CALIB_UNSEEN ) {
+			l->min[c] = l->center[c] = l->max[c] = 0;
+			continue;
+		}
+
+		// Switches rest at an endpoint, so their centre is between the two
+		bool atEnd = ( l->center[c] - l->min[c] < CALIB_HALFSPAN_MIN || l->max[c] - l->center[c] < CALIB_HALFSPAN_MIN );
+		if ( atEnd && l->max[c] - l->min[c] >= 2 * CALIB_HALFSPAN_MIN ) {
+			l->center[c] = (l->min[c] + l->max[c]) / 2;
+		}
+	}
+	for ( uint8_t c = l->chCount; c < CALIB_CH_NUM; c++ ) {
+		l->min[c] = 0;
+	}
+	l->check = CALIB_Check( l );
+
+	if ( rec != NULL ) { *rec = *l; }
+
+	return CALIB_Load( cal, l );
+}
+
+/*
+ * CALIB_isLearning
+ *  -
+ */
+bool CALIB_isLearning ( const CALIB_t * cal )
+{
+	return cal->learning;
+}
+
+/*
+ * CALIB_Apply
+ *  - Maps the channels in mask from in to out, clamped to RADIO_CH_MIN/MAX. 0 (no data)
+ *    stays 0. in may be out. The others keep what out holds.
+ *  - Channels from another source than the maps were learned on pass through.
+ *  - One multiply per calibrated channel, no division.
+ */
+void CALIB_Apply ( const CALIB_t * cal, uint8_t source, const uint16_t * in, uint16_t * out, uint8_t count, uint32_t mask )
+{
+	bool match = source == cal->source;
+
+	for ( uint8_t c = 0; c < count; c++ )
+	{
+		if ( !((mask >> c) & 1) ) { continue; }
+
+		uint16_t center = ( match && c < CALIB_CH_NUM ) ? cal->map[c].center : 0;
+		if ( center == 0 || in[c] == 0 ) {
+			out[c] = in[c];
+			continue;
+		}
+
+		int32_t d = (int32_t)in[c] - center;
+		int32_t gain = d < 0 ? cal->map[c].gainLow : cal->map[c].gainHigh;
+		int32_t us = RADIO_CH_CENTER + ((d * gain) >> CALIB_GAIN_SHIFT);
+
+		out[c] = (uint16_t)RADIO_MAX( RADIO_MIN( us, RADIO_CH_MAX ), RADIO_CH_MIN );
+	}
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * CALIB_Check
+ *  -
+ */
+static uint8_t CALIB_Check ( const CALIB_record_t * rec )
+{
+	uint8_t check = CALIB_CHECK ^ rec->chCount ^ (uint8_t)(rec->source << 1);
+	for ( uint8_t c = 0; c < CALIB_CH_NUM; c++ ) {
+		check ^= (uint8_t)rec->min[c]    ^ (uint8_t)(rec->min[c] >> 8);
+		check ^= (uint8_t)rec->center[c] ^ (uint8_t)(rec->center[c] >> 8);
+		check ^= (uint8_t)rec->max[c]    ^ (uint8_t)(rec->max[c] >> 8);
+		check = (uint8_t)((check << 1) | (check >> 7));
+	}
+	return check;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,80 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef CALIB_H
+#define CALIB_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Per-channel endpoint and centre calibration. While learning, each channel's lowest,
+ * highest and latest value are tracked; the latest becomes the centre, so release the
+ * sticks before finishing. The learned points are then compiled into a two-slope map
+ * per channel taking them onto RADIO_CH_MIN, RADIO_CH_CENTER and RADIO_CH_MAX.
+ *
+ * Channels that moved less than CALIB_HALFSPAN_MIN either side of the centre are left
+ * as they are. Two position switches are centred between their endpoints.
+ *
+ * Endpoints only hold for the transmitter path they were learned on, so the record
+ * carries the caller's key for it (source). Samples from another source start the
+ * learning over, and the maps only apply to their own source.
+ */
+#ifndef CALIB_CH_NUM
+#define CALIB_CH_NUM			16		// Channels calibrated, later ones pass through
+#endif
+
+#define CALIB_HALFSPAN_MIN		150		// Microseconds, keeps the gains within CALIB_GAIN_SHIFT
+#define CALIB_GAIN_SHIFT		14
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Learned points, persisted through RADIO_storage_t. 0 for a channel that was not seen */
+typedef struct {
+	uint8_t		chCount;
+	uint8_t		check;		/* Integrity byte, maintained by the library	*/
+	uint8_t		source;		/* Input the points were learned on				*/
+	uint16_t	min[CALIB_CH_NUM];
+	uint16_t	center[CALIB_CH_NUM];
+	uint16_t	max[CALIB_CH_NUM];
+} CALIB_record_t;
+
+/* Compiled map of one channel */
+typedef struct {
+	uint16_t	center;		/* Input centre, 0 if the channel passes through	*/
+	uint16_t	gainLow;	/* Below the centre, Q14							*/
+	uint16_t	gainHigh;	/* Above the centre, Q14							*/
+} CALIB_map_t;
+
+typedef struct {
+	bool 			learning;
+	uint8_t			source;		/* Input the maps belong to	*/
+	CALIB_record_t	learn;
+	CALIB_map_t		map[CALIB_CH_NUM];
+} CALIB_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void 		CALIB_Init		( CALIB_t * );
+bool 		CALIB_Load		( CALIB_t *, const CALIB_record_t * );
+
+void 		CALIB_Start		( CALIB_t * );
+void 		CALIB_Sample	( CALIB_t *, uint8_t, const uint16_t *, uint8_t, uint32_t );
+bool 		CALIB_Finish	( CALIB_t *, CALIB_record_t * );
+bool 		CALIB_isLearning( const CALIB_t * );
+
+void 		CALIB_Apply		( const CALIB_t *, uint8_t, const uint16_t *, uint16_t *, uint8_t, uint32_t );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* CALIB_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,213 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Failsafe.h"
+#include "Radio.h"
+
+#ifdef RADIO_USE_FAILSAFE
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void 	FAILSAFE_Enter		( FAILSAFE_t *, uint32_t );
+static void 	FAILSAFE_Advance	( FAILSAFE_t *, uint32_t );
+static uint16_t*	FAILSAFE_Mix	( FAILSAFE_t *, const uint16_t *, const uint16_t *, uint32_t, uint8_t );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * FAILSAFE_Init
+ *  - Takes the policies of the first count channels and builds the failsafe frame.
+ *    Later channels pass through. stageMs: hold time before the policies apply, or 0.
+ *  - A channel lost before its first input holds RADIO_CH_CENTER, or goes straight to its value.
+ *  - Returns the number of channels configured, at most FAILSAFE_CH_NUM.
+ */
+uint8_t FAILSAFE_Init ( FAILSAFE_t * fs, const FAILSAFE_channel_t * table, uint8_t count, uint32_t stageMs )
+{
+	memset( fs, 0, sizeof(*fs) );
+	fs->count	= RADIO_MIN( count, FAILSAFE_CH_NUM );
+	fs->stageMs	= stageMs;
+
+	for ( uint8_t c = 0; c < fs->count; c++ )
+	{
+		fs->cfg[c] = table[c];
+		if ( table[c].mode == FAILSAFE_Ramp && table[c].rampMs > 0 ) {
+			fs->ramps |= 1UL << c;
+		} else if ( table[c].mode == FAILSAFE_Ramp ) {
+			fs->cfg[c].mode = FAILSAFE_Preset;
+		}
+		// Hold channels are filled in on the way into failsafe
+		fs->frame[c] = table[c].mode == FAILSAFE_Hold ? 0 : table[c].value;
+		// Until a channel has input there is nothing to hold or ramp from: Hold takes
+		// the centre, the others start at their value
+		fs->last[c]	 = table[c].mode == FAILSAFE_Hold ? RADIO_CH_CENTER : table[c].value;
+	}
+
+	return fs->count;
+}
+
+/*
+ * FAILSAFE_Apply
+ *  - Call every update with the channels (us), their lost flags and CORE_GetTick().
+ *    At most FAILSAFE_CH_NUM channels.
+ *  - Afterwards FAILSAFE_Output() gives the channels to use in place of ch.
+ */
+void FAILSAFE_Apply ( FAILSAFE_t * fs, const uint16_t * ch, uint8_t count, uint32_t lost, uint32_t now )
+{
+	uint32_t dt = now - fs->tick;
+	fs->tick = now;
+
+	uint8_t n = RADIO_MIN( count, fs->count );
+	lost &= RADIO_CH_MASK(n);
+
+	// Every channel with input is the value to hold should it be lost
+	for ( uint8_t c = 0; c < n; c++ ) {
+		if ( !((lost >> c) & 1) && ch[c] != 0 ) { fs->last[c] = ch[c]; }
+	}
+
+	fs->substituted = lost;
+	if ( lost == 0 ) {
+		fs->stage	= FAILSAFE_Off;
+		fs->hard	= 0;
+		fs->output	= NULL;
+		return;
+	}
+
+	if ( fs->stage == FAILSAFE_Off ) {
+		fs->stage = FAILSAFE_Staged;
+		fs->since = now;
+	}
+
+	// The whole frame lost is the common case, and is handed out without a copy
+	bool whole = n == count && lost == RADIO_CH_MASK(n);
+
+	if ( fs->stage == FAILSAFE_Staged && (now - fs->since) < fs->stageMs ) {
+		fs->output = whole ? fs->last : FAILSAFE_Mix( fs, ch, fs->last, lost, count );
+		return;
+	}
+
+	fs->stage = FAILSAFE_Active;
+	FAILSAFE_Enter( fs, lost & ~fs->hard );
+	fs->hard = lost;
+	FAILSAFE_Advance( fs, dt );
+
+	fs->output = whole ? fs->frame : FAILSAFE_Mix( fs, ch, fs->frame, lost, count );
+}
+
+/*
+ * FAILSAFE_Output
+ *  - The channels to use: ch, or their substitute while any are lost.
+ */
+uint16_t* FAILSAFE_Output ( FAILSAFE_t * fs, uint16_t * ch )
+{
+	return fs->output != NULL ? fs->output : ch;
+}
+
+/*
+ * FAILSAFE_getStage
+ *  - FAILSAFE_stage_t as of the last FAILSAFE_Apply().
+ */
+uint8_t FAILSAFE_getStage ( FAILSAFE_t * fs )
+{
+	return fs->stage;
+}
+
+/*
+ * FAILSAFE_getSubstituted
+ *  - Lost channels FAILSAFE_Output() gives a value in place of, as of the last FAILSAFE_Apply().
+ */
+uint32_t FAILSAFE_getSubstituted ( FAILSAFE_t * fs )
+{
+	return fs->substituted;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * FAILSAFE_Enter
+ *  - Starts the policy of each channel newly in failsafe. Presets are already in the frame.
+ */
+static void FAILSAFE_Enter ( FAILSAFE_t * fs, uint32_t entered )
+{
+	for ( uint8_t c = 0; entered; c++, entered >>= 1 )
+	{
+		if ( !(entered & 1) ) { continue; }
+
+		const FAILSAFE_channel_t * cfg = &fs->cfg[c];
+		switch ( cfg->mode ) {
+		case FAILSAFE_Hold:
+			fs->frame[c] = fs->last[c];
+			break;
+		case FAILSAFE_Ramp:
+			fs->frame[c] = fs->last[c];
+			fs->ramp[c]	 = (int32_t)fs->last[c] << 16;
+			fs->rate[c]	 = (((int32_t)cfg->value - fs->last[c]) << 16) / cfg->rampMs;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/*
+ * FAILSAFE_Advance
+ *  - Moves the ramping channels dt ms towards their value.
+ */
+static void FAILSAFE_Advance ( FAILSAFE_t * fs, uint32_t dt )
+{
+	uint32_t ramps = fs->ramps & fs->hard;
+
+	for ( uint8_t c = 0; ramps; c++, ramps >>= 1 )
+	{
+		if ( !(ramps & 1) || fs->frame[c] == fs->cfg[c].value ) { continue; }
+
+		// Past rampMs the value is reached anyway, which also bounds the product
+		int32_t target	= (int32_t)fs->cfg[c].value << 16;
+		fs->ramp[c]	   += fs->rate[c] * (int32_t)RADIO_MIN( dt, fs->cfg[c].rampMs );
+		if ( (fs->rate[c] > 0) ? (fs->ramp[c] > target) : (fs->ramp[c] < target) ) {
+			fs->ramp[c] = target;
+		}
+		fs->frame[c] = (uint16_t)(fs->ramp[c] >> 16);
+	}
+}
+
+/*
+ * FAILSAFE_Mix
+ *  - Some channels lost: those take sub, the others and any not configured ch.
+ */
+static uint16_t* FAILSAFE_Mix ( FAILSAFE_t * fs, const uint16_t * ch, const uint16_t * sub, uint32_t lost, uint8_t count )
+{
+	count = RADIO_MIN( count, FAILSAFE_CH_NUM );
+	for ( uint8_t c = 0; c < count; c++ ) {
+		fs->mixed[c] = ((lost >> c) & 1) ? sub[c] : ch[c];
+	}
+	return fs->mixed;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,84 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef FAILSAFE_H
+#define FAILSAFE_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Output substitution for lost channels (microseconds). A lost channel first holds its
+ * last value for the stage time, if any, then takes its policy:
+ *
+ *  - FAILSAFE_Hold:	keeps the last value received.
+ *  - FAILSAFE_Preset:	jumps to value.
+ *  - FAILSAFE_Ramp:	moves from the last value to value over rampMs.
+ *
+ * The failsafe frame is built in advance, so when every channel is lost the outputs
+ * switch to it by pointer. Only Hold and Ramp channels are written on the way in.
+ */
+#ifndef FAILSAFE_CH_NUM
+#define FAILSAFE_CH_NUM			16		// Channels configured, at least those of any protocol built in
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef enum {
+	FAILSAFE_Hold,
+	FAILSAFE_Preset,
+	FAILSAFE_Ramp,
+} FAILSAFE_mode_t;
+
+typedef enum {
+	FAILSAFE_Off,			/* No configured channel lost				*/
+	FAILSAFE_Staged,		/* Lost channels hold, within the stage time	*/
+	FAILSAFE_Active,		/* Lost channels follow their policy			*/
+} FAILSAFE_stage_t;
+
+/* Settings of one channel, in channel order */
+typedef struct {
+	uint8_t		mode;		// FAILSAFE_mode_t
+	uint16_t	value;		// Microseconds, Preset and Ramp
+	uint16_t	rampMs;		// Ramp time, 0 jumps like Preset
+} FAILSAFE_channel_t;
+
+typedef struct {
+	uint8_t				count;					/* Channels configured, 0 to pass through	*/
+	uint8_t				stage;					/* FAILSAFE_stage_t							*/
+	uint32_t			stageMs;				/* Hold time before the policies apply		*/
+	uint32_t			since;					/* Tick the first channel was lost			*/
+	uint32_t			tick;					/* Tick of the last FAILSAFE_Apply()		*/
+	uint32_t			hard;					/* Channels following their policy			*/
+	uint32_t			substituted;			/* Channels the output substitutes			*/
+	uint32_t			ramps;					/* Channels with a Ramp policy				*/
+	uint16_t *			output;					/* Substituted channels, NULL to pass		*/
+	FAILSAFE_channel_t	cfg[FAILSAFE_CH_NUM];
+	uint16_t			last[FAILSAFE_CH_NUM];	/* Last value of each channel with input	*/
+	uint16_t			frame[FAILSAFE_CH_NUM];	/* Failsafe frame, presets built in advance	*/
+	uint16_t			mixed[FAILSAFE_CH_NUM];	/* Outputs while only some channels are lost	*/
+	int32_t				ramp[FAILSAFE_CH_NUM];	/* Ramp position, Q16 microseconds			*/
+	int32_t				rate[FAILSAFE_CH_NUM];	/* Ramp step, Q16 microseconds per ms		*/
+} FAILSAFE_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+uint8_t		FAILSAFE_Init		( FAILSAFE_t *, const FAILSAFE_channel_t *, uint8_t, uint32_t );
+void 		FAILSAFE_Apply		( FAILSAFE_t *, const uint16_t *, uint8_t, uint32_t, uint32_t );
+uint16_t*	FAILSAFE_Output		( FAILSAFE_t *, uint16_t * );
+uint8_t		FAILSAFE_getStage	( FAILSAFE_t * );
+uint32_t	FAILSAFE_getSubstituted	( FAILSAFE_t * );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* FAILSAFE_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
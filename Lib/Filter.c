@@ -0,0 +1,143 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Filter.h"
+#include "Radio.h"
+
+#ifdef RADIO_USE_FILTER
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static uint16_t	FILTER_Median3	( uint16_t, uint16_t, uint16_t );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * FILTER_Init
+ *  - Takes the settings of the first count channels. Later channels pass through.
+ *  - Returns the number of channels configured, at most FILTER_CH_NUM.
+ */
+uint8_t FILTER_Init ( FILTER_t * f, const FILTER_channel_t * table, uint8_t count )
+{
+	memset( f, 0, sizeof(*f) );
+	f->count = RADIO_MIN( count, FILTER_CH_NUM );
+	memcpy( f->cfg, table, f->count * sizeof(f->cfg[0]) );
+
+	return f->count;
+}
+
+/*
+ * FILTER_Reset
+ *  - Forgets the history, e.g when the channels switch source. The next sample of each channel passes through.
+ */
+void FILTER_Reset ( FILTER_t * f )
+{
+	f->primed = 0;
+	f->held	  = 0;
+	memset( f->hist, 0, sizeof(f->hist) );
+}
+
+/*
+ * FILTER_Apply
+ *  - Filters the channels in sampled, those with a new sample, from ch to out (microseconds).
+ *    The others keep what out holds, their history as it was.
+ *  - Lost channels, channels without data (0) and any not configured pass through,
+ *    the first two restarting their history.
+ */
+void FILTER_Apply ( FILTER_t * f, const uint16_t * ch, uint16_t * out, uint8_t count, uint32_t lost, uint32_t sampled )
+{
+	uint8_t n = RADIO_MIN( count, f->count );
+	if ( f->primed != n ) {
+		FILTER_Reset( f );
+		f->primed = n;
+	}
+
+	sampled |= lost;
+	for ( uint8_t c = 0; c < count; c++ )
+	{
+		uint32_t bit	= 1UL << c;
+		if ( !(sampled & bit) ) { continue; }
+
+		uint16_t in		= ch[c];
+		out[c]			= in;
+		if ( c >= n ) { continue; }
+
+		uint16_t * h	= f->hist[c];
+		uint16_t limit	= f->cfg[c].limit;
+
+		if ( (lost & bit) || in == 0 || h[0] == 0 ) {
+			h[0] = h[1] = in;
+			f->held &= ~bit;
+			continue;
+		}
+
+		switch ( f->cfg[c].mode ) {
+		case FILTER_Median:
+			out[c] = FILTER_Median3( h[1], h[0], in );
+			h[1] = h[0];
+			h[0] = in;
+			break;
+
+		case FILTER_RateLimit:
+		case FILTER_Confirm:
+			// h[0] is the last output. A jump is only ever held back for one sample
+			if ( !(f->held & bit) && (in > h[0] + limit || in + limit < h[0]) ) {
+				f->held |= bit;
+				if ( f->cfg[c].mode == FILTER_RateLimit ) {
+					out[c] = in > h[0] ? h[0] + limit : h[0] - limit;
+				} else {
+					out[c] = h[0];
+				}
+			} else {
+				f->held &= ~bit;
+			}
+			h[0] = out[c];
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * FILTER_Median3
+ *  -
+ */
+static uint16_t FILTER_Median3 ( uint16_t a, uint16_t b, uint16_t c )
+{
+	uint16_t lo = RADIO_MIN( a, b );
+	uint16_t hi = RADIO_MAX( a, b );
+	return RADIO_MAX( lo, RADIO_MIN( hi, c ) );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
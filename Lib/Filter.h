@@ -0,0 +1,66 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef FILTER_H
+#define FILTER_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Per-channel glitch filter for single-frame spikes (e.g EMI on PPM/PWM lines or a
+ * corrupt SBUS frame that passed its checks). Runs on integer microseconds, from the
+ * decoder's channels into a copy the caller owns. Each channel's history only moves on
+ * when it has a new sample, so PWM channels, which pulse one after another, see each
+ * pulse once. Every mode delays a real step by at most one sample:
+ *
+ *  - FILTER_Median:	median of the last three frames. A step arrives one frame late.
+ *  - FILTER_RateLimit:	a jump beyond limit moves by limit for one frame, then completes.
+ *  - FILTER_Confirm:	a jump beyond limit is held off for one frame and taken on the next.
+ */
+#ifndef FILTER_CH_NUM
+#define FILTER_CH_NUM			16		// Channels filtered, later ones pass through
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef enum {
+	FILTER_None,
+	FILTER_Median,
+	FILTER_RateLimit,
+	FILTER_Confirm,
+} FILTER_mode_t;
+
+/* Settings of one channel, in channel order */
+typedef struct {
+	uint8_t		mode;		// FILTER_mode_t
+	uint16_t	limit;		// Microseconds per frame, RateLimit and Confirm
+} FILTER_channel_t;
+
+typedef struct {
+	uint8_t				count;					/* Channels configured						*/
+	uint8_t				primed;					/* Channels filtered, a change restarts		*/
+	uint32_t			held;					/* Channels limited or held last frame		*/
+	FILTER_channel_t	cfg[FILTER_CH_NUM];
+	uint16_t			hist[FILTER_CH_NUM][2];	/* Last two inputs, or last output first. 0 to restart	*/
+} FILTER_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+uint8_t		FILTER_Init		( FILTER_t *, const FILTER_channel_t *, uint8_t );
+void 		FILTER_Reset	( FILTER_t * );
+void 		FILTER_Apply	( FILTER_t *, const uint16_t *, uint16_t *, uint8_t, uint32_t, uint32_t );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* FILTER_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
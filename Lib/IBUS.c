@@ -1,328 +1,635 @@
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#include "IBUS.h"
-
-#if defined(RADIO_USE_IBUS)
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-#define IBUS_HEADER1_LEN	1
-#define IBUS_HEADER2_LEN	1
-#define IBUS_DATA_LEN		2
-#define IBUS_CHECKSUM_LEN	2
-#define IBUS_PAYLOAD_LEN	(IBUS_HEADER1_LEN + IBUS_HEADER2_LEN + (IBUS_DATA_LEN * IBUS_NUM_CHANNELS) + IBUS_CHECKSUM_LEN)
-
-#define IBUS_HEADER1_INDEX	0
-#define IBUS_HEADER2_INDEX	(IBUS_HEADER1_INDEX + IBUS_HEADER1_LEN)
-#define IBUS_DATA_INDEX		(IBUS_HEADER2_INDEX + IBUS_HEADER2_LEN)
-#define IBUS_CHECKSUM_INDEX	(IBUS_DATA_INDEX + (IBUS_DATA_LEN * IBUS_NUM_CHANNELS))
-
-#define IBUS_HEADER1		0x20
-#define IBUS_HEADER2		0x40
-#define IBUS_CHECKSUM_START	0xFFFF
-
-#define IBUS_JITTER_ARRAY	3		// Given 7ms payload period, ~21ms input lag
-#define IBUS_THRESHOLD		500
-#define IBUS_DROPPED_FRAMES	3
-#define IBUS_TIMEOUT_FS		(IBUS_PERIOD * IBUS_DROPPED_FRAMES) // Failsafe timeout. How long radio lost before failsafe is activated
-#define IBUS_TIMEOUT_IP		4 // Input timeout. How long after detecting message headers does remaining read timeout.
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE TYPES										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE PROTOTYPES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-uint32_t	IBUS_Truncate	( uint32_t );
-bool 		IBUS_Checksum	( void );
-void 		IBUS_HandleUART	( void );
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE VARIABLES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-uint8_t 	rxIBUS[IBUS_PAYLOAD_LEN] = {0};
-bool 		rxHeartbeatIBUS = false;
-IBUS_Data	dataIBUS = {0};
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void IBUS_Init ( void )
-{
-	memset(rxIBUS, 0, sizeof(rxIBUS));
-	rxHeartbeatIBUS = false;
-	dataIBUS.inputLost = true;
-
-	UART_Init(IBUS_UART, IBUS_BAUD, UART_Mode_Default);
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void IBUS_Deinit ( void )
-{
-	UART_Deinit(IBUS_UART);
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-bool IBUS_Detect ( void )
-{
-	IBUS_Init();
-
-	uint32_t tick = CORE_GetTick();
-	while ((IBUS_TIMEOUT_FS * 2) > CORE_GetTick() - tick)
-	{
-		IBUS_Update();
-		CORE_Idle();
-	}
-
-	if ( dataIBUS.inputLost )
-	{
-		IBUS_Deinit();
-	}
-
-	return !dataIBUS.inputLost;
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void IBUS_Update ( void )
-{
-	// Update Rx Data
-	IBUS_HandleUART();
-
-	// Update Loop Variables
-	uint32_t now = CORE_GetTick();
-	static uint32_t tick = 0;
-
-	// Check for New Input Data
-	if (rxHeartbeatIBUS)
-	{
-		// Assign Input to data Struct
-		uint8_t ch = 0;
-		for (uint8_t i = IBUS_DATA_INDEX; i < (IBUS_PAYLOAD_LEN - IBUS_CHECKSUM_LEN); i += 2)
-		{
-			uint32_t trunc = (int32_t)(rxIBUS[i] | rxIBUS[i+1] << 8);
-			dataIBUS.ch[ch] = IBUS_Truncate(trunc);
-			ch += 1;
-		}
-		// Reset Flags
-		rxHeartbeatIBUS = false;
-		dataIBUS.inputLost = false;
-		tick = now;
-	}
-
-	// Check for Input Failsafe
-	if (!dataIBUS.inputLost && IBUS_TIMEOUT_FS <= (now - tick)) { // If not receiving data and inputLost flag not set
-		dataIBUS.inputLost = true;
-		memset(rxIBUS, 0, sizeof(rxIBUS));
-	}
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-IBUS_Data* IBUS_getDataPtr ( void )
-{
-	return &dataIBUS;
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE FUNCTIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-uint32_t IBUS_Truncate ( uint32_t r )
-{
-	uint32_t retVal = 0;
-
-	if (r == 0) {
-		retVal = 0;
-	} else if (r < (IBUS_MIN - IBUS_THRESHOLD)) {
-		retVal = 0;
-	} else if (r < IBUS_MIN) {
-		retVal = IBUS_MIN;
-	} else if (r <= IBUS_MAX) {
-		retVal = r;
-	} else if (r < (IBUS_MAX + IBUS_THRESHOLD))	{
-		retVal = IBUS_MAX;
-	} else {
-		retVal = 0;
-	}
-
-	return retVal;
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-bool IBUS_Checksum ( void )
-{
-	bool retVal = false;
-
-	uint32_t cs = (int32_t)(rxIBUS[IBUS_CHECKSUM_INDEX] | (int32_t)rxIBUS[IBUS_CHECKSUM_INDEX + 1] << 8);
-	uint32_t check = IBUS_CHECKSUM_START;
-	check -= IBUS_HEADER1;
-	check -= IBUS_HEADER2;
-	for (uint8_t i = IBUS_DATA_INDEX; i < IBUS_CHECKSUM_INDEX; i++)
-	{
-		check -= rxIBUS[i];
-	}
-
-	if (cs == check)
-	{
-		retVal = true;
-	}
-
-	return retVal;
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void IBUS_HandleUART ( void )
-{
-	// Init Loop Variables
-	uint32_t now = CORE_GetTick();
-	static uint32_t timeout = 0;
-	static bool detH1 = false;
-	static bool detH2 = false;
-
-	// Check for Start of transmission (Header1)
-	if ( !detH1 )
-	{
-		// Process All Available Bytes in Buffer Until Header1 Detected
-		while ( UART_ReadCount(IBUS_UART) >= IBUS_HEADER1_LEN)
-		{
-			// Read in Next Byte
-			UART_Read(IBUS_UART, &rxIBUS[IBUS_HEADER1_INDEX], IBUS_HEADER1_LEN);
-			// Check if the Byte is the Message Header1
-			if (rxIBUS[IBUS_HEADER1_INDEX] == IBUS_HEADER1) {
-				detH1 = true;
-				timeout = now + IBUS_TIMEOUT_IP;
-				break;
-			}
-		}
-	}
-
-	// Header1 Detected, Check for Header2
-	if ( detH1 && !detH2)
-	{
-		// Only Proceed When Byte in Buffer
-		if ( UART_ReadCount(IBUS_UART) >= IBUS_HEADER2_LEN )
-		{
-			// Read in Next Byte
-			UART_Read(IBUS_UART, &rxIBUS[IBUS_HEADER2_INDEX], IBUS_HEADER2_LEN);
-			// Check if the Byte is the Message Header1
-			if (rxIBUS[IBUS_HEADER2_INDEX] == IBUS_HEADER2) {
-				detH2 = true;
-				timeout = now + IBUS_TIMEOUT_IP;
-			} else if (rxIBUS[IBUS_HEADER2_INDEX] == IBUS_HEADER1) { // Case for 2 sequential 0x20 bytes
-				// Do nothing. Next loop will re-check for Header2
-			} else {
-				detH1 = false;
-			}
-		}
-
-		// Check for a timeout
-		if ( now > timeout )
-		{
-			detH1 = false;
-			detH2 = false;
-		}
-	}
-
-	// Both Headers Detected, Read Remaining Transmission
-	if ( detH1 && detH2 )
-	{
-		// Only Proceed When Full Message is Ready
-		if ( UART_ReadCount(IBUS_UART) >= (IBUS_PAYLOAD_LEN - IBUS_HEADER1_LEN - IBUS_HEADER2_LEN) )
-		{
-			// Read in Remaining Message
-			UART_Read(IBUS_UART, &rxIBUS[IBUS_DATA_INDEX], (IBUS_PAYLOAD_LEN - IBUS_HEADER1_LEN - IBUS_HEADER2_LEN));
-			// Verify the Checksum
-			if (IBUS_Checksum()) {
-				rxHeartbeatIBUS = true;
-			}
-			// Reset detect for next read weather or not CS is correct
-			detH1 = false;
-			detH2 = false;
-		}
-
-		// Check for a timeout
-		if ( now > timeout)
-		{
-			detH1 = false;
-			detH2 = false;
-		}
-	}
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EVENT HANDLERS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* INTERRUPT ROUTINES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#endif
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "IBUS.h"
+#include "Radio.h"
+
+#if defined(RADIO_USE_IBUS)
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#define IBUS_HEADER1_INDEX	0
+#define IBUS_HEADER2_INDEX	(IBUS_HEADER1_INDEX + IBUS_HEADER1_LEN)
+#define IBUS_DATA_INDEX		(IBUS_HEADER2_INDEX + IBUS_HEADER2_LEN)
+#define IBUS_CHECKSUM_INDEX	(IBUS_DATA_INDEX + (IBUS_DATA_LEN * IBUS_CH_NUM))
+
+#define IBUS_HEADER1		0x20
+#define IBUS_HEADER2		0x40
+#define IBUS_CHECKSUM_START	0xFFFF
+
+#define IBUS_THRESHOLD		500
+#define IBUS_DROPPED_FRAMES	3
+#define IBUS_TIMEOUT_FS		TIMEBASE_MS(IBUS_PERIOD * IBUS_DROPPED_FRAMES) // Failsafe timeout. Longest the radio can be lost before failsafe is activated
+#define IBUS_TIMEOUT_GAP	8 // Silence mid frame that aborts it, in characters
+#define IBUS_TIMEOUT_SLACK	500 // Added to a frame's time on the wire before it is abandoned (us)
+#define IBUS_CHAR_BITS		10 // 8N1
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+static uint32_t	IBUS_Truncate	( uint32_t );
+#ifdef RADIO_PARSE_IN_IRQ
+static void 	IBUS_Parse		( IBUS_t *, uint8_t );
+#else
+#ifndef RADIO_RX_IN_IRQ
+static void 	IBUS_HandleUART	( IBUS_t * );
+#endif
+static void 	IBUS_ParseRing	( IBUS_t * );
+#endif
+static void 	IBUS_Publish	( IBUS_t *, const uint8_t * );
+
+static bool 	IBUS_opsInit			( void *, uint32_t, bool );
+static void 	IBUS_opsDeinit			( void * );
+static bool 	IBUS_opsDetect			( void * );
+static void 	IBUS_opsUpdate			( void * );
+static uint16_t*	IBUS_opsGetData			( void * );
+#ifdef RADIO_USE_HIRES
+static int16_t*	IBUS_opsGetNormalised	( void * );
+static uint16_t*	IBUS_opsGetRaw			( void * );
+#endif
+static uint32_t	IBUS_opsGetInputLost	( void * );
+static uint32_t	IBUS_opsGetFrameCount	( void * );
+static uint32_t	IBUS_opsGetFrameTime	( void * );
+static uint8_t	IBUS_opsGetLinkQuality	( void * );
+static void 	IBUS_opsOnFrame			( void *, void (*)(void) );
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+static void 	IBUS_opsRxByte			( void *, uint8_t );
+#endif
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* Dispatch table for Radio.c, which keeps an IBUS_t per input */
+const RADIO_ops_t IBUS_ops = {
+	.chCount		= IBUS_CH_NUM,
+	.init			= IBUS_opsInit,
+	.deinit			= IBUS_opsDeinit,
+	.detect			= IBUS_opsDetect,
+	.update			= IBUS_opsUpdate,
+	.getData		= IBUS_opsGetData,
+#ifdef RADIO_USE_HIRES
+	.getNormalised	= IBUS_opsGetNormalised,
+	.getRaw			= IBUS_opsGetRaw,
+#endif
+	.getInputLost	= IBUS_opsGetInputLost,
+	.getFrameCount	= IBUS_opsGetFrameCount,
+	.getLinkQuality	= IBUS_opsGetLinkQuality,
+	.getFrameTime	= IBUS_opsGetFrameTime,
+	.onFrame		= IBUS_opsOnFrame,
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+	.rxByte			= IBUS_opsRxByte,
+#endif
+};
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * Binds the receiver to a UART and starts it. Clears any callback, so IBUS_OnFrame() goes after this.
+ * Any number of receivers can run, each with its own IBUS_t and UART.
+ *
+ * INPUTS: baud - normally IBUS_BAUD, inverted - true if the line idles low
+ * OUTPUTS:
+ */
+void IBUS_Init ( IBUS_t * ibus, UART_t * uart, uint32_t baud, bool inverted )
+{
+	memset(ibus, 0, sizeof(*ibus));
+	ibus->uart = uart;
+#ifdef RADIO_PARSE_IN_IRQ
+	ibus->rxIndex = IBUS_HEADER1_INDEX;
+#else
+	RING_Init(&ibus->ring, ibus->ringBuffer, sizeof(ibus->ringBuffer));
+#endif
+	ibus->fill = 1;
+	ibus->charUs = TIMEBASE_CharUs(baud, IBUS_CHAR_BITS);
+	ibus->data.inputLost = true;
+	TIMEBASE_RateInit(&ibus->rate, IBUS_TIMEOUT_FS);
+
+	UART_Init(uart, baud, inverted ? UART_Mode_Inverted : UART_Mode_Default);
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+void IBUS_Deinit ( IBUS_t * ibus )
+{
+	UART_Deinit(ibus->uart);
+}
+
+
+/*
+ * Non-blocking. Call after IBUS_Update() during detection.
+ *
+ * INPUTS:
+ * OUTPUTS: True once valid frames are being received
+ */
+bool IBUS_Detect ( IBUS_t * ibus )
+{
+	return !ibus->data.inputLost;
+}
+
+
+/*
+ * Parses buffered bytes, then takes the last complete frame.
+ * With RADIO_PARSE_IN_IRQ the bytes were already parsed by IBUS_RX_IRQ().
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+void IBUS_Update ( IBUS_t * ibus )
+{
+#ifndef RADIO_PARSE_IN_IRQ
+	// Update Rx Data
+#ifndef RADIO_RX_IN_IRQ
+	IBUS_HandleUART(ibus);
+#endif
+	IBUS_ParseRing(ibus);
+#endif
+
+	// Update Loop Variables
+	uint32_t seq = ibus->rxSeq;
+
+	// Check for New Input Data
+	if (seq != ibus->frameCount)
+	{
+		// Copy the published frame. If the parser publishes again mid copy the
+		// buffer may be reused, so repeat with the newer frame.
+		do {
+			seq = ibus->rxSeq;
+			uint8_t ready = ibus->rxReady;
+			for (uint8_t i = 0; i < IBUS_CH_NUM; i++)
+			{
+				uint16_t r = ibus->rxCh[ready][i];
+				ibus->data.ch[i] = IBUS_Truncate(r);
+#ifdef RADIO_USE_HIRES
+				ibus->raw[i] = r;
+				ibus->norm[i] = ibus->data.ch[i] ? RADIO_Q15(ibus->data.ch[i], IBUS_MIN, IBUS_MAX) : 0;
+#endif
+			}
+			ibus->frameTime = ibus->rxTime[ready];
+		} while (seq != ibus->rxSeq);
+
+		TIMEBASE_RateFrame(&ibus->rate, ibus->frameTime, seq - ibus->frameCount);
+
+		// Reset Flags
+		ibus->data.inputLost = false;
+		ibus->frameCount = seq;
+
+#ifndef RADIO_PARSE_IN_IRQ
+		if (ibus->onFrame != NULL) { ibus->onFrame(); }
+#endif
+	}
+
+	// Check for Input Failsafe
+	if (!ibus->data.inputLost && TIMEBASE_Elapsed(ibus->frameTime, TIMEBASE_RateTimeout(&ibus->rate))) { // If not receiving data and inputLost flag not set
+		ibus->data.inputLost = true;
+	}
+}
+
+
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+/*
+ * Call from the receive interrupt of the receiver's UART with each byte received.
+ * RADIO_RX_IN_IRQ queues it for IBUS_Update(), dropped if the ring is full.
+ * RADIO_PARSE_IN_IRQ parses it straight away at a bounded cost per byte,
+ * the checksum is kept as bytes arrive.
+ *
+ * INPUTS: byte - received byte
+ * OUTPUTS:
+ */
+void IBUS_RX_IRQ ( IBUS_t * ibus, uint8_t byte )
+{
+#ifdef RADIO_PARSE_IN_IRQ
+	IBUS_Parse(ibus, byte);
+#else
+	RING_Put(&ibus->ring, byte);
+#endif
+}
+#endif
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+IBUS_Data* IBUS_getDataPtr ( IBUS_t * ibus )
+{
+	return &ibus->data;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+uint16_t* IBUS_getData ( IBUS_t * ibus )
+{
+	return ibus->data.ch;
+}
+
+
+#ifdef RADIO_USE_HIRES
+/*
+ * Channels as Q15, +-32767 for IBUS_MIN to IBUS_MAX, without rounding to microseconds
+ *
+ * INPUTS:
+ * OUTPUTS: Q15 per channel, 0 where the channel has no data
+ */
+int16_t* IBUS_getNormalised ( IBUS_t * ibus )
+{
+	return ibus->norm;
+}
+
+
+/*
+ * Channel values as received, before bounding and scaling
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+uint16_t* IBUS_getRaw ( IBUS_t * ibus )
+{
+	return ibus->raw;
+}
+#endif
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+uint32_t IBUS_getInputLost ( IBUS_t * ibus )
+{
+	return ibus->data.inputLost ? RADIO_CH_MASK(IBUS_CH_NUM) : 0;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS: Number of valid frames decoded. Wraps.
+ */
+uint32_t IBUS_getFrameCount ( IBUS_t * ibus )
+{
+	return ibus->frameCount;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS: US_Read() timestamp of the last frame, taken when its last byte was parsed
+ */
+uint32_t IBUS_getFrameTime ( IBUS_t * ibus )
+{
+	return ibus->frameTime;
+}
+
+
+/*
+ * IBUS carries no link statistics
+ *
+ * INPUTS:
+ * OUTPUTS: 100 while receiving, else 0
+ */
+uint8_t IBUS_getLinkQuality ( IBUS_t * ibus )
+{
+	return ibus->data.inputLost ? 0 : 100;
+}
+
+
+/*
+ * Registers a callback fired from IBUS_Update() as soon as a valid frame is committed,
+ * or from IBUS_RX_IRQ() with RADIO_PARSE_IN_IRQ
+ *
+ * INPUTS: callback - NULL to remove
+ * OUTPUTS:
+ */
+void IBUS_OnFrame ( IBUS_t * ibus, void (*callback)(void) )
+{
+	ibus->onFrame = callback;
+}
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+static uint32_t IBUS_Truncate ( uint32_t r )
+{
+	uint32_t retVal = 0;
+
+	if (r == 0) {
+		retVal = 0;
+	} else if (r < (IBUS_MIN - IBUS_THRESHOLD)) {
+		retVal = 0;
+	} else if (r < IBUS_MIN) {
+		retVal = IBUS_MIN;
+	} else if (r <= IBUS_MAX) {
+		retVal = r;
+	} else if (r < (IBUS_MAX + IBUS_THRESHOLD))	{
+		retVal = IBUS_MAX;
+	} else {
+		retVal = 0;
+	}
+
+	return retVal;
+}
+
+
+#ifdef RADIO_PARSE_IN_IRQ
+/*
+ * Advances the frame state machine by one byte
+ *
+ * INPUTS: byte - received byte
+ * OUTPUTS:
+ */
+static void IBUS_Parse ( IBUS_t * ibus, uint8_t byte )
+{
+	// Bytes arrive as they are received, so a gap this long means the frame was cut short
+	uint32_t now = TIMEBASE_Now();
+	if (ibus->rxIndex != IBUS_HEADER1_INDEX && (now - ibus->rxStart) >= ibus->charUs * IBUS_TIMEOUT_GAP)
+	{
+		ibus->rxIndex = IBUS_HEADER1_INDEX;
+	}
+	ibus->rxStart = now;
+
+	switch (ibus->rxIndex)
+	{
+	// Check for Start of transmission (Header1)
+	case IBUS_HEADER1_INDEX:
+		if (byte == IBUS_HEADER1) {
+			ibus->rx[IBUS_HEADER1_INDEX] = byte;
+			ibus->rxIndex = IBUS_HEADER2_INDEX;
+		}
+		break;
+
+	// Header1 Detected, Check for Header2
+	case IBUS_HEADER2_INDEX:
+		if (byte == IBUS_HEADER2) {
+			ibus->rx[IBUS_HEADER2_INDEX] = byte;
+			ibus->rxIndex = IBUS_DATA_INDEX;
+			ibus->rxCheck = IBUS_CHECKSUM_START - IBUS_HEADER1 - IBUS_HEADER2;
+		} else if (byte == IBUS_HEADER1) { // Case for 2 sequential 0x20 bytes
+			// Do nothing. Next byte will re-check for Header2
+		} else {
+			ibus->rxIndex = IBUS_HEADER1_INDEX;
+		}
+		break;
+
+	// Both Headers Detected, Read Remaining Transmission
+	default:
+		ibus->rx[ibus->rxIndex] = byte;
+		if (ibus->rxIndex < IBUS_CHECKSUM_INDEX) {
+			ibus->rxCheck -= byte;
+		}
+		ibus->rxIndex++;
+		if (ibus->rxIndex >= IBUS_PAYLOAD_LEN)
+		{
+			// Verify the Checksum
+			uint32_t cs = (uint32_t)(ibus->rx[IBUS_CHECKSUM_INDEX] | ibus->rx[IBUS_CHECKSUM_INDEX + 1] << 8);
+			if (cs == ibus->rxCheck) {
+				IBUS_Publish(ibus, ibus->rx);
+			}
+			// Reset detect for next read weather or not CS is correct
+			ibus->rxIndex = IBUS_HEADER1_INDEX;
+		}
+		break;
+	}
+}
+#else
+#ifndef RADIO_RX_IN_IRQ
+/*
+ * Moves everything the UART driver has buffered into the ring,
+ * one block read per contiguous span
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+static void IBUS_HandleUART ( IBUS_t * ibus )
+{
+	uint32_t count = UART_ReadCount(ibus->uart);
+
+	while (count > 0)
+	{
+		uint8_t * span;
+		uint32_t n = RING_WriteSpan(&ibus->ring, &span);
+		if (n == 0) { break; }
+		if (n > count) { n = count; }
+
+		UART_Read(ibus->uart, span, n);
+		RING_Write(&ibus->ring, n);
+		count -= n;
+	}
+}
+#endif
+
+
+/*
+ * Validates frames in place at the front of the ring. A frame is consumed whole
+ * once its headers and checksum check out, otherwise the ring moves on one byte.
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+static void IBUS_ParseRing ( IBUS_t * ibus )
+{
+	uint32_t count;
+
+	while ((count = RING_Count(&ibus->ring)) >= IBUS_HEADER1_LEN + IBUS_HEADER2_LEN)
+	{
+		// Check for Start of transmission (Header1 and Header2)
+		if (RING_Peek(&ibus->ring, IBUS_HEADER1_INDEX) != IBUS_HEADER1
+		 || RING_Peek(&ibus->ring, IBUS_HEADER2_INDEX) != IBUS_HEADER2)
+		{
+			RING_Skip(&ibus->ring, 1);
+			ibus->rxPending = false;
+			continue;
+		}
+
+		// Headers Detected, Wait for Remaining Transmission
+		if (count < IBUS_PAYLOAD_LEN)
+		{
+			if (!ibus->rxPending) {
+				ibus->rxPending = true;
+				ibus->rxStart = TIMEBASE_Now();
+			} else if (TIMEBASE_Elapsed(ibus->rxStart, IBUS_PAYLOAD_LEN * ibus->charUs + IBUS_TIMEOUT_SLACK)) {
+				RING_Skip(&ibus->ring, 1);
+				ibus->rxPending = false;
+				continue;
+			}
+			break;
+		}
+		ibus->rxPending = false;
+
+		// Verify the Checksum
+		uint32_t check = IBUS_CHECKSUM_START - IBUS_HEADER1 - IBUS_HEADER2;
+		for (uint8_t i = IBUS_DATA_INDEX; i < IBUS_CHECKSUM_INDEX; i++)
+		{
+			check -= RING_Peek(&ibus->ring, i);
+		}
+		uint32_t cs = (uint32_t)(RING_Peek(&ibus->ring, IBUS_CHECKSUM_INDEX) | RING_Peek(&ibus->ring, IBUS_CHECKSUM_INDEX + 1) << 8);
+		if (cs != check)
+		{
+			RING_Skip(&ibus->ring, 1);
+			continue;
+		}
+
+		IBUS_Publish(ibus, RING_Linearise(&ibus->ring, ibus->rx, IBUS_PAYLOAD_LEN));
+		RING_Skip(&ibus->ring, IBUS_PAYLOAD_LEN);
+	}
+}
+#endif
+
+
+/*
+ * Copies the channels of a frame into the fill buffer and publishes it
+ *
+ * INPUTS: frame - complete, validated frame
+ * OUTPUTS:
+ */
+static void IBUS_Publish ( IBUS_t * ibus, const uint8_t * frame )
+{
+	uint8_t ch = 0;
+	for (uint8_t i = IBUS_DATA_INDEX; i < IBUS_CHECKSUM_INDEX; i += IBUS_DATA_LEN)
+	{
+		ibus->rxCh[ibus->fill][ch++] = frame[i] | frame[i+1] << 8;
+	}
+
+	// Publish the frame and fill the other buffer next
+	ibus->rxTime[ibus->fill] = US_Read();
+	ibus->rxReady = ibus->fill;
+	ibus->fill ^= 1;
+	ibus->rxSeq++;
+
+#ifdef RADIO_PARSE_IN_IRQ
+	if (ibus->onFrame != NULL) { ibus->onFrame(); }
+#endif
+}
+
+
+/*
+ * IBUS_ops entries
+ * ctx is the IBUS_t of the Radio.c input, which is bound to IBUS_UART
+ *
+ * INPUTS: ctx - IBUS_t
+ * OUTPUTS:
+ */
+static bool IBUS_opsInit ( void * ctx, uint32_t baud, bool inverted )
+{
+	IBUS_Init(ctx, IBUS_UART, baud, inverted);
+	return true;
+}
+
+static void IBUS_opsDeinit ( void * ctx )
+{
+	IBUS_Deinit(ctx);
+}
+
+static bool IBUS_opsDetect ( void * ctx )
+{
+	return IBUS_Detect(ctx);
+}
+
+static void IBUS_opsUpdate ( void * ctx )
+{
+	IBUS_Update(ctx);
+}
+
+static uint16_t* IBUS_opsGetData ( void * ctx )
+{
+	return IBUS_getData(ctx);
+}
+
+#ifdef RADIO_USE_HIRES
+static int16_t* IBUS_opsGetNormalised ( void * ctx )
+{
+	return IBUS_getNormalised(ctx);
+}
+
+static uint16_t* IBUS_opsGetRaw ( void * ctx )
+{
+	return IBUS_getRaw(ctx);
+}
+#endif
+
+static uint32_t IBUS_opsGetInputLost ( void * ctx )
+{
+	return IBUS_getInputLost(ctx);
+}
+
+static uint32_t IBUS_opsGetFrameCount ( void * ctx )
+{
+	return IBUS_getFrameCount(ctx);
+}
+
+static uint32_t IBUS_opsGetFrameTime ( void * ctx )
+{
+	return IBUS_getFrameTime(ctx);
+}
+
+static uint8_t IBUS_opsGetLinkQuality ( void * ctx )
+{
+	return IBUS_getLinkQuality(ctx);
+}
+
+static void IBUS_opsOnFrame ( void * ctx, void (*callback)(void) )
+{
+	IBUS_OnFrame(ctx, callback);
+}
+
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+static void IBUS_opsRxByte ( void * ctx, uint8_t byte )
+{
+	IBUS_RX_IRQ(ctx, byte);
+}
+#endif
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -1,62 +1,125 @@
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#ifndef IBUS_H
-#define IBUS_H
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-#include "STM32X.h"
-
-#include "Core.h"
-#include "UART.h"
-#include "GPIO.h"
-#include "US.h"
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-#define IBUS_CH_NUM			14
-
-#define IBUS_BAUD			115200
-
-#define IBUS_PERIOD			7
-#define IBUS_MIN			0x3E8	// == 1000
-#define IBUS_CENTER			0x5DC	// == 1500
-#define IBUS_MAX			0x7D0	// == 2000
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC TYPES      									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-typedef struct {
-	bool inputLost;
-	uint32_t ch[IBUS_CH_NUM];
-} IBUS_Data;
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-void 		IBUS_Init 		( void );
-void 		IBUS_Deinit 	( void );
-bool 		IBUS_Detect		( void );
-void 		IBUS_Update 	( void );
-
-IBUS_Data*	IBUS_getDataPtr	( void );
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EXTERN DECLARATIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#endif /* SBUS_H */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef IBUS_H
+#define IBUS_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "STM32X.h"
+
+#include "Core.h"
+#include "UART.h"
+#include "GPIO.h"
+#include "US.h"
+#include "Ring.h"
+#include "Timebase.h"
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#define IBUS_CH_NUM			14
+
+#define IBUS_BAUD			115200
+
+#define IBUS_PERIOD			7
+#define IBUS_DETECT_MS		(IBUS_PERIOD * 6)	// Listen window during detection
+#define IBUS_MIN			0x3E8	// == 1000
+#define IBUS_CENTER			0x5DC	// == 1500
+#define IBUS_MAX			0x7D0	// == 2000
+
+#define IBUS_HEADER1_LEN	1
+#define IBUS_HEADER2_LEN	1
+#define IBUS_DATA_LEN		2
+#define IBUS_CHECKSUM_LEN	2
+#define IBUS_PAYLOAD_LEN	(IBUS_HEADER1_LEN + IBUS_HEADER2_LEN + (IBUS_DATA_LEN * IBUS_CH_NUM) + IBUS_CHECKSUM_LEN)
+
+#define IBUS_RING_SIZE		64 // Serial ring, power of two and at least two frames
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+typedef struct {
+	bool inputLost;
+	uint16_t ch[IBUS_CH_NUM];
+} IBUS_Data;
+
+/*
+ * One IBUS receiver, bound to a UART by IBUS_Init().
+ * Only the IBUS_* functions touch it.
+ */
+typedef struct {
+	UART_t * uart;
+	uint32_t charUs;						// One character at the configured baud
+	uint32_t rxStart;						// Header seen (ring) or last byte (IRQ)
+	uint8_t rx[IBUS_PAYLOAD_LEN];
+#ifdef RADIO_PARSE_IN_IRQ
+	// Parser state - owned by IBUS_Parse(), which runs in the RX interrupt
+	uint8_t rxIndex;						// Next byte of rx, header1 while searching
+	uint32_t rxCheck;						// Running checksum of the bytes received
+#else
+	// Bytes waiting to be parsed, from IBUS_RX_IRQ() or drained from the UART driver
+	uint8_t ringBuffer[IBUS_RING_SIZE];
+	RING_t ring;
+	bool rxPending;							// Partial frame at the front of the ring
+#endif
+
+	// Double buffer - the parser fills one while the other holds the last complete frame
+	volatile uint16_t rxCh[2][IBUS_CH_NUM];
+	volatile uint8_t rxReady;				// Buffer holding the last complete frame
+	volatile uint32_t rxSeq;				// Incremented by the parser for each complete frame
+	volatile uint32_t rxTime[2];			// US_Read() at the last byte of each buffer's frame
+	uint8_t fill;							// Buffer being filled, never rxReady
+
+	IBUS_Data data;
+#ifdef RADIO_USE_HIRES
+	uint16_t raw[IBUS_CH_NUM];				// Channel values as received
+	int16_t norm[IBUS_CH_NUM];				// Q15 of the raw values, 0 where data.ch is 0
+#endif
+	uint32_t frameCount;
+	uint32_t frameTime;
+	TIMEBASE_rate_t rate;					// Frame rate, sets the failsafe timeout
+	void (*onFrame)(void);
+} IBUS_t;
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+void 		IBUS_Init 			( IBUS_t *, UART_t *, uint32_t, bool );
+void 		IBUS_Deinit 		( IBUS_t * );
+bool 		IBUS_Detect			( IBUS_t * );
+void 		IBUS_Update 		( IBUS_t * );
+
+uint16_t*	IBUS_getData		( IBUS_t * );
+#ifdef RADIO_USE_HIRES
+int16_t*	IBUS_getNormalised	( IBUS_t * );
+uint16_t*	IBUS_getRaw			( IBUS_t * );
+#endif
+uint32_t	IBUS_getInputLost	( IBUS_t * );
+uint32_t	IBUS_getFrameCount	( IBUS_t * );
+uint32_t	IBUS_getFrameTime	( IBUS_t * );
+uint8_t		IBUS_getLinkQuality	( IBUS_t * );
+void 		IBUS_OnFrame		( IBUS_t *, void (*)(void) );
+IBUS_Data*	IBUS_getDataPtr		( IBUS_t * );
+
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+void 		IBUS_RX_IRQ			( IBUS_t *, uint8_t );
+#endif
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* SBUS_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
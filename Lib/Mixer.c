@@ -0,0 +1,153 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Mixer.h"
+#include "Radio.h"
+
+#ifdef RADIO_USE_MIXER
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#define MIXER_SPAN				(MIXER_SEG_NUM << MIXER_SEG_SHIFT)
+#define MIXER_SEG_MASK			((1 << MIXER_SEG_SHIFT) - 1)
+#define MIXER_IN_GAIN			(((MIXER_SPAN << 16) + RADIO_CH_FULLSCALE - 1) / RADIO_CH_FULLSCALE)	// Microseconds to curve position, Q16 rounded up
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static int32_t	MIXER_Curve		( const MIXER_channel_t *, int32_t );
+static int32_t	MIXER_Clamp		( int32_t );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * MIXER_Init
+ *  - Compiles table (one entry per output) into the output curves. Not for the
+ *    control loop: it does the divisions MIXER_Apply() avoids.
+ *  - Returns the number of outputs, at most MIXER_CH_NUM.
+ */
+uint8_t MIXER_Init ( MIXER_t * m, const MIXER_channel_t * table, uint8_t count )
+{
+	memset( m, 0, sizeof(*m) );
+	m->count = RADIO_MIN( count, MIXER_CH_NUM );
+
+	for ( uint8_t i = 0; i < m->count; i++ )
+	{
+		m->source[i] = table[i].source;
+		for ( uint8_t k = 0; k < MIXER_LUT_POINTS; k++ ) {
+			int32_t x = (2 * k - MIXER_SEG_NUM) * MIXER_Q15_ONE / MIXER_SEG_NUM;
+			m->lut[i][k] = MIXER_Curve( &table[i], x );
+		}
+	}
+
+	return m->count;
+}
+
+/*
+ * MIXER_Apply
+ *  - Maps a frame of input channels (microseconds) to the outputs. Run once per new frame.
+ *  - Outputs whose source is lost (bit set in lost) or has no data (0) hold their last
+ *    value, centred until the source is first seen. Those whose source is past inCount are centred.
+ */
+void MIXER_Apply ( MIXER_t * m, const uint16_t * in, uint8_t inCount, uint32_t lost )
+{
+	for ( uint8_t i = 0; i < m->count; i++ ) {
+		uint8_t src = m->source[i];
+		if ( src >= inCount ) {
+			m->out[i] = 0;
+		} else if ( !((lost >> src) & 1) && in[src] != 0 ) {
+			m->out[i] = MIXER_Map( m, i, in[src] );
+		}
+	}
+}
+
+/*
+ * MIXER_Map
+ *  - One input value through output i's curve. Inputs outside RADIO_CH_MIN/MAX take the end value.
+ */
+int16_t MIXER_Map ( const MIXER_t * m, uint8_t i, uint16_t us )
+{
+	const int16_t * lut = m->lut[i];
+
+	if ( us <= RADIO_CH_MIN ) { return lut[0]; }
+	if ( us >= RADIO_CH_MAX ) { return lut[MIXER_SEG_NUM]; }
+
+	uint32_t pos = ((uint32_t)(us - RADIO_CH_MIN) * MIXER_IN_GAIN) >> 16;
+	uint32_t seg = pos >> MIXER_SEG_SHIFT;
+
+	int32_t a = lut[seg];
+	int32_t b = lut[seg + 1];
+	return (int16_t)( a + (((b - a) * (int32_t)(pos & MIXER_SEG_MASK)) >> MIXER_SEG_SHIFT) );
+}
+
+/*
+ * MIXER_getOutput
+ *  - Q15 outputs from the last MIXER_Apply(), in table order.
+ */
+int16_t* MIXER_getOutput ( MIXER_t * m )
+{
+	return m->out;
+}
+
+/*
+ * MIXER_getCount
+ *  -
+ */
+uint8_t MIXER_getCount ( const MIXER_t * m )
+{
+	return m->count;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * MIXER_Curve
+ *  - Output (Q15) of one channel's settings at normalised input x (Q15):
+ *    y = rate * ((1 - expo) * x + expo * x^3) + offset, x reversed if set.
+ */
+static int32_t MIXER_Curve ( const MIXER_channel_t * c, int32_t x )
+{
+	if ( c->reverse ) { x = -x; }
+
+	int64_t x3 = (int64_t)x * x / MIXER_Q15_ONE * x / MIXER_Q15_ONE;
+	int64_t y = ( (int64_t)x * (100 - c->expo) + x3 * c->expo ) / 100;
+	y = y * c->rate / 100;
+	y += (int32_t)c->offset * MIXER_Q15_ONE / RADIO_CH_HALFSCALE;
+
+	return MIXER_Clamp( (int32_t)RADIO_MAX( RADIO_MIN( y, INT32_MAX ), INT32_MIN ) );
+}
+
+/*
+ * MIXER_Clamp
+ *  -
+ */
+static int32_t MIXER_Clamp ( int32_t q15 )
+{
+	return RADIO_MAX( RADIO_MIN( q15, MIXER_Q15_ONE ), -MIXER_Q15_ONE );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
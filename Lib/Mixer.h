@@ -0,0 +1,66 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef MIXER_H
+#define MIXER_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Post-decode channel mixer. A table of per-output settings (source channel, reverse,
+ * rate, expo, offset) is compiled once by MIXER_Init() into a piecewise-linear curve
+ * per output. MIXER_Apply() then maps each output with two multiplies, shifts and two
+ * table reads - no division or floating point.
+ *
+ * Outputs are Q15: -32767 is full low, 0 centre, 32767 full high.
+ */
+#ifndef MIXER_CH_NUM
+#define MIXER_CH_NUM			16		// Outputs
+#endif
+
+#define MIXER_Q15_ONE			32767
+#define MIXER_SEG_SHIFT			6		// Interpolation steps per curve segment, as a shift
+#define MIXER_SEG_NUM			16		// Curve segments from RADIO_CH_MIN to RADIO_CH_MAX
+#define MIXER_LUT_POINTS		(MIXER_SEG_NUM + 1)
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Settings of one output. Outputs are in table order, so remapping (e.g AETR to TAER) is the source order */
+typedef struct {
+	uint8_t		source;		// Input channel, 0 for CH1
+	bool 		reverse;
+	uint8_t		rate;		// Percent of full travel, 100 for none
+	uint8_t		expo;		// Percent, 0 for linear. Softens the centre, keeps the endpoints
+	int16_t		offset;		// Microseconds added after rate and expo (e.g trim)
+} MIXER_channel_t;
+
+typedef struct {
+	uint8_t		count;
+	uint8_t		source[MIXER_CH_NUM];
+	int16_t		lut[MIXER_CH_NUM][MIXER_LUT_POINTS];
+	int16_t		out[MIXER_CH_NUM];
+} MIXER_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+uint8_t		MIXER_Init		( MIXER_t *, const MIXER_channel_t *, uint8_t );
+void 		MIXER_Apply		( MIXER_t *, const uint16_t *, uint8_t, uint32_t );
+int16_t		MIXER_Map		( const MIXER_t *, uint8_t, uint16_t );
+
+int16_t*	MIXER_getOutput	( MIXER_t * );
+uint8_t		MIXER_getCount	( const MIXER_t * );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* MIXER_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -1,277 +1,494 @@
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#include "PPM.h"
-
-#if defined(RADIO_USE_PPM)
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-#define PPM_EOF_TIME		4000
-#define PPM_THRESHOLD		100
-#define PPM_TIMEOUT_CYCLES	3
-#define PPM_TIMEOUT			(PPM_PERIOD * PPM_TIMEOUT_CYCLES)
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE TYPES										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE PROTOTYPES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-static uint32_t	PPM_Truncate	( uint32_t );
-static void 	PPM_resetArrays	( void );
-
-static void 	PPM_CH_IRQ	( void );
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE VARIABLES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-volatile uint16_t rxPPM[PPM_CH_NUM] = {0};
-volatile bool rxHeartbeatPPM = false;
-PPM_Data dataPPM = {0};
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void PPM_Init ( void )
-{
-	PPM_resetArrays();
-	rxHeartbeatPPM = false;
-	dataPPM.inputLost = true;
-
-	TIM_Init(TIM_RADIO, TIM_RADIO_FREQ, TIM_RADIO_RELOAD);
-	TIM_Start(TIM_RADIO);
-
-	GPIO_EnableInput(PPM_CH_Pin, GPIO_Pull_Down);
-	GPIO_OnChange(PPM_CH_Pin, GPIO_IT_Rising, PPM_CH_IRQ);
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void PPM_Deinit ( void )
-{
-	TIM_Deinit(TIM_RADIO);
-
-	GPIO_OnChange(PPM_CH_Pin, GPIO_IT_None, NULL);
-	GPIO_Deinit(PPM_CH_Pin);
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-bool PPM_DetInit ( void )
-{
-	PPM_Init();
-
-	uint32_t tick = CORE_GetTick();
-	while ((PPM_TIMEOUT * 2) > CORE_GetTick() - tick)
-	{
-		CORE_Idle();
-	}
-
-	if ( !rxHeartbeatPPM )
-	{
-		PPM_Deinit();
-	}
-
-	return rxHeartbeatPPM;
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void PPM_Update ( void )
-{
-	// Init Loop Variables
-	uint32_t now = CORE_GetTick();
-	static uint32_t prev = 0;
-	static uint32_t ch_p[PPM_CH_NUM];
-	// Check for New Input Data
-	if (rxHeartbeatPPM)
-	{
-		// Assign Input to data Struct
-		for (uint8_t i = 0; i < PPM_CH_NUM; i++)
-		{
-			ch_p[i] = dataPPM.ch[i];
-			dataPPM.ch[i] = PPM_Truncate(rxPPM[i]);
-		}
-
-		// Reset Flags
-		rxHeartbeatPPM = false;
-		dataPPM.inputLost = false;
-		prev = now;
-	}
-
-	// Assign Input to data Struct
-	for (uint8_t i = 0; i < PPM_CH_NUM; i++)
-	{
-		if ( dataPPM.ch[i] != 0 &&
-			 ((dataPPM.ch[i] >= (ch_p[i] + 20)) ||
-			 (dataPPM.ch[i] <= (ch_p[i] - 20))))
-		{
-			rxHeartbeatPPM = false;
-		}
-	}
-
-	// Check for Input Failsafe
-	if (!dataPPM.inputLost && PPM_TIMEOUT <= (now - prev)) {
-		dataPPM.inputLost = true;
-		PPM_resetArrays();
-	}
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-PPM_Data* PPM_GetDataPtr ( void )
-{
-	return &dataPPM;
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE FUNCTIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-static uint32_t PPM_Truncate ( uint32_t r )
-{
-	uint32_t retVal = 0;
-
-	if (r == 0) {
-		retVal = 0;
-	} else if (r < (PPM_MIN - PPM_THRESHOLD)) {
-		retVal = 0;
-	} else if (r < PPM_MIN) {
-		retVal = PPM_MIN;
-	} else if (r <= PPM_MAX) {
-		retVal = r;
-	} else if (r < (PPM_MAX + PPM_THRESHOLD))	{
-		retVal = PPM_MAX;
-	} else {
-		retVal = 0;
-	}
-
-	return retVal;
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-static void PPM_resetArrays ( void )
-{
-	for (uint8_t i = 0; i < PPM_CH_NUM; i++)
-	{
-		rxPPM[i] = 0;
-	}
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EVENT HANDLERS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* INTERRUPT ROUTINES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-static void PPM_CH_IRQ ( void )
-{
-	uint32_t now = TIM_Read(TIM_RADIO);	// Current IRQ Loop Time
-	uint32_t pulse = 0;					// Pulse Width
-	static uint32_t tick = 0;			// Previous IRQ Loop Time
-	static uint8_t ch = 0;				// Channel Index
-	static bool sync = false;			// Sync Flag to Indicate Start of Transmission
-
-	// Calculate the Pulse Width
-	pulse = now - tick;
-
-	// Check for Channel 1 Synchronization
-	if (pulse > PPM_EOF_TIME)
-	{
-		ch = 0;
-		sync = true;
-	}
-	// Assign Pulse to Channel
-	else if (sync)
-	{
-		// Check for valid pulse
-		if (pulse <= (PPM_MAX + PPM_THRESHOLD) && pulse >= (PPM_MIN - PPM_THRESHOLD)) {
-			rxPPM[ch] = pulse;
-			ch += 1;
-		} else { // Pulse train is corrupted. Abort transmission.
-			sync = false;
-		}
-		// If on Last Channel
-		if (ch >= PPM_CH_NUM)
-		{
-			rxHeartbeatPPM = true;
-			sync = false;
-		}
-
-	}
-
-	// Set variables for next loop
-	tick = now;
-
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#endif
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "PPM.h"
+#include "Radio.h"
+
+#if defined(RADIO_USE_PPM)
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#define PPM_EOF_TIME		4000
+#define PPM_THRESHOLD		100
+#define PPM_TIMEOUT_CYCLES	3
+#define PPM_TIMEOUT			TIMEBASE_MS(PPM_PERIOD * PPM_TIMEOUT_CYCLES)
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+static uint32_t	PPM_Truncate	( uint32_t );
+
+static bool 	PPM_opsInit				( void *, uint32_t, bool );
+static void 	PPM_opsDeinit			( void * );
+static bool 	PPM_opsDetect			( void * );
+static void 	PPM_opsUpdate			( void * );
+static uint16_t*	PPM_opsGetData			( void * );
+#ifdef RADIO_USE_HIRES
+static int16_t*	PPM_opsGetNormalised	( void * );
+static uint16_t*	PPM_opsGetRaw			( void * );
+#endif
+static uint32_t	PPM_opsGetInputLost		( void * );
+static uint32_t	PPM_opsGetFrameCount	( void * );
+static uint32_t	PPM_opsGetFrameTime		( void * );
+static uint8_t	PPM_opsGetLinkQuality	( void * );
+static void 	PPM_opsOnFrame			( void *, void (*)(void) );
+
+static void 	PPM_CH_IRQ	( PPM_t * );
+static void 	PPM_IRQ0	( void );
+#if PPM_INSTANCE_NUM >= 2
+static void 	PPM_IRQ1	( void );
+#endif
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+// Receiver using each pin interrupt handler. GPIO_OnChange() handlers take no arguments.
+static PPM_t * instances[PPM_INSTANCE_NUM] = {0};
+static void (* const irqHandler[PPM_INSTANCE_NUM])(void) = {
+	PPM_IRQ0,
+#if PPM_INSTANCE_NUM >= 2
+	PPM_IRQ1,
+#endif
+};
+
+
+/* Dispatch table for Radio.c, which keeps a PPM_t per input */
+const RADIO_ops_t PPM_ops = {
+	.chCount		= PPM_CH_NUM,
+	.init			= PPM_opsInit,
+	.deinit			= PPM_opsDeinit,
+	.detect			= PPM_opsDetect,
+	.update			= PPM_opsUpdate,
+	.getData		= PPM_opsGetData,
+#ifdef RADIO_USE_HIRES
+	.getNormalised	= PPM_opsGetNormalised,
+	.getRaw			= PPM_opsGetRaw,
+#endif
+	.getInputLost	= PPM_opsGetInputLost,
+	.getFrameCount	= PPM_opsGetFrameCount,
+	.getLinkQuality	= PPM_opsGetLinkQuality,
+	.getFrameTime	= PPM_opsGetFrameTime,
+	.onFrame		= PPM_opsOnFrame,
+};
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * Binds the receiver to an input pin and a free running timer, and starts it.
+ * Each receiver needs its own timer. Clears any callback, so PPM_OnFrame() goes after this.
+ *
+ * INPUTS: pin - PPM input, tim - started at TIM_RADIO_FREQ
+ * OUTPUTS: False if PPM_INSTANCE_NUM receivers are already running
+ */
+bool PPM_Init ( PPM_t * ppm, uint32_t pin, TIM_t * tim )
+{
+	// Claim a pin interrupt handler
+	uint8_t slot = 0;
+	while (slot < PPM_INSTANCE_NUM && instances[slot] != NULL && instances[slot] != ppm) {
+		slot++;
+	}
+	if (slot >= PPM_INSTANCE_NUM) {
+		return false;
+	}
+
+	memset(ppm, 0, sizeof(*ppm));
+	ppm->pin = pin;
+	ppm->tim = tim;
+	ppm->slot = slot;
+	ppm->fill = 1;
+	ppm->data.inputLost = true;
+	TIMEBASE_RateInit(&ppm->rate, PPM_TIMEOUT);
+	instances[slot] = ppm;
+
+	TIM_Init(tim, TIM_RADIO_FREQ, TIM_RADIO_RELOAD);
+	TIM_Start(tim);
+
+	GPIO_EnableInput(pin, GPIO_Pull_Down);
+	GPIO_OnChange(pin, GPIO_IT_Rising, irqHandler[slot]);
+
+	return true;
+}
+
+
+/*
+ * Stops the receiver and releases its pin interrupt handler
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+void PPM_Deinit ( PPM_t * ppm )
+{
+	TIM_Deinit(ppm->tim);
+
+	GPIO_OnChange(ppm->pin, GPIO_IT_None, NULL);
+	GPIO_Deinit(ppm->pin);
+
+	instances[ppm->slot] = NULL;
+}
+
+
+/*
+ * Non-blocking. Call after PPM_Update() during detection.
+ *
+ * INPUTS:
+ * OUTPUTS: True once complete pulse trains are being received
+ */
+bool PPM_Detect ( PPM_t * ppm )
+{
+	return !ppm->data.inputLost;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+void PPM_Update ( PPM_t * ppm )
+{
+	// Init Loop Variables
+	uint32_t seq = ppm->rxSeq;
+	// Check for New Input Data
+	if (seq != ppm->frameCount)
+	{
+		// Copy the published frame. If the IRQ publishes again mid copy the
+		// buffer may be reused, so repeat with the newer frame.
+		do {
+			seq = ppm->rxSeq;
+			uint8_t ready = ppm->rxReady;
+			for (uint8_t i = 0; i < PPM_CH_NUM; i++)
+			{
+				uint16_t r = ppm->rx[ready][i];
+				ppm->data.ch[i] = PPM_Truncate(r);
+#ifdef RADIO_USE_HIRES
+				ppm->raw[i] = r;
+				ppm->norm[i] = ppm->data.ch[i] ? RADIO_Q15(ppm->data.ch[i], PPM_MIN, PPM_MAX) : 0;
+#endif
+			}
+			ppm->frameTime = ppm->rxTime[ready];
+		} while (seq != ppm->rxSeq);
+
+		TIMEBASE_RateFrame(&ppm->rate, ppm->frameTime, seq - ppm->frameCount);
+
+		// Reset Flags
+		ppm->data.inputLost = false;
+		ppm->frameCount = seq;
+	}
+
+	// Check for Input Failsafe
+	if (!ppm->data.inputLost && TIMEBASE_Elapsed(ppm->frameTime, TIMEBASE_RateTimeout(&ppm->rate))) {
+		ppm->data.inputLost = true;
+	}
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+PPM_Data* PPM_getDataPtr ( PPM_t * ppm )
+{
+	return &ppm->data;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+uint16_t* PPM_getData ( PPM_t * ppm )
+{
+	return ppm->data.ch;
+}
+
+
+#ifdef RADIO_USE_HIRES
+/*
+ * Channels as Q15, +-32767 for PPM_MIN to PPM_MAX, without rounding to microseconds
+ *
+ * INPUTS:
+ * OUTPUTS: Q15 per channel, 0 where the channel has no data
+ */
+int16_t* PPM_getNormalised ( PPM_t * ppm )
+{
+	return ppm->norm;
+}
+
+
+/*
+ * Channel values as received, before bounding and scaling
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+uint16_t* PPM_getRaw ( PPM_t * ppm )
+{
+	return ppm->raw;
+}
+#endif
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+uint32_t PPM_getInputLost ( PPM_t * ppm )
+{
+	return ppm->data.inputLost ? RADIO_CH_MASK(PPM_CH_NUM) : 0;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS: Number of complete pulse trains received. Wraps.
+ */
+uint32_t PPM_getFrameCount ( PPM_t * ppm )
+{
+	return ppm->frameCount;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS: US_Read() timestamp of the closing edge of the last pulse train
+ */
+uint32_t PPM_getFrameTime ( PPM_t * ppm )
+{
+	return ppm->frameTime;
+}
+
+
+/*
+ * PPM carries no link statistics
+ *
+ * INPUTS:
+ * OUTPUTS: 100 while receiving, else 0
+ */
+uint8_t PPM_getLinkQuality ( PPM_t * ppm )
+{
+	return ppm->data.inputLost ? 0 : 100;
+}
+
+
+/*
+ * Registers a callback fired from interrupt context as soon as a valid frame is committed
+ *
+ * INPUTS: callback - NULL to remove
+ * OUTPUTS:
+ */
+void PPM_OnFrame ( PPM_t * ppm, void (*callback)(void) )
+{
+	ppm->onFrame = callback;
+}
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * PPM_ops entries
+ * ctx is the PPM_t of the Radio.c input, which is bound to PPM_CH_Pin and TIM_RADIO.
+ * Not a serial protocol, so the line settings are unused.
+ *
+ * INPUTS: ctx - PPM_t
+ * OUTPUTS:
+ */
+static bool PPM_opsInit ( void * ctx, uint32_t baud, bool inverted )
+{
+	(void)baud;
+	(void)inverted;
+	return PPM_Init(ctx, PPM_CH_Pin, TIM_RADIO);
+}
+
+static void PPM_opsDeinit ( void * ctx )
+{
+	PPM_Deinit(ctx);
+}
+
+static bool PPM_opsDetect ( void * ctx )
+{
+	return PPM_Detect(ctx);
+}
+
+static void PPM_opsUpdate ( void * ctx )
+{
+	PPM_Update(ctx);
+}
+
+static uint16_t* PPM_opsGetData ( void * ctx )
+{
+	return PPM_getData(ctx);
+}
+
+#ifdef RADIO_USE_HIRES
+static int16_t* PPM_opsGetNormalised ( void * ctx )
+{
+	return PPM_getNormalised(ctx);
+}
+
+static uint16_t* PPM_opsGetRaw ( void * ctx )
+{
+	return PPM_getRaw(ctx);
+}
+#endif
+
+static uint32_t PPM_opsGetInputLost ( void * ctx )
+{
+	return PPM_getInputLost(ctx);
+}
+
+static uint32_t PPM_opsGetFrameCount ( void * ctx )
+{
+	return PPM_getFrameCount(ctx);
+}
+
+static uint32_t PPM_opsGetFrameTime ( void * ctx )
+{
+	return PPM_getFrameTime(ctx);
+}
+
+static uint8_t PPM_opsGetLinkQuality ( void * ctx )
+{
+	return PPM_getLinkQuality(ctx);
+}
+
+static void PPM_opsOnFrame ( void * ctx, void (*callback)(void) )
+{
+	PPM_OnFrame(ctx, callback);
+}
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+static uint32_t PPM_Truncate ( uint32_t r )
+{
+	uint32_t retVal = 0;
+
+	if (r == 0) {
+		retVal = 0;
+	} else if (r < (PPM_MIN - PPM_THRESHOLD)) {
+		retVal = 0;
+	} else if (r < PPM_MIN) {
+		retVal = PPM_MIN;
+	} else if (r <= PPM_MAX) {
+		retVal = r;
+	} else if (r < (PPM_MAX + PPM_THRESHOLD))	{
+		retVal = PPM_MAX;
+	} else {
+		retVal = 0;
+	}
+
+	return retVal;
+}
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * Rising edge of the receiver's pin
+ *
+ * INPUTS: ppm - receiver bound to the pin
+ * OUTPUTS:
+ */
+static void PPM_CH_IRQ ( PPM_t * ppm )
+{
+	uint32_t now = TIM_Read(ppm->tim);	// Current IRQ Loop Time
+	uint32_t pulse = 0;					// Pulse Width
+
+	// Calculate the Pulse Width
+	pulse = now - ppm->tick;
+
+	// Check for Channel 1 Synchronization
+	if (pulse > PPM_EOF_TIME)
+	{
+		ppm->ch = 0;
+		ppm->sync = true;
+	}
+	// Assign Pulse to Channel
+	else if (ppm->sync)
+	{
+		// Check for valid pulse
+		if (pulse <= (PPM_MAX + PPM_THRESHOLD) && pulse >= (PPM_MIN - PPM_THRESHOLD)) {
+			ppm->rx[ppm->fill][ppm->ch] = pulse;
+			ppm->ch += 1;
+		} else { // Pulse train is corrupted. Abort transmission.
+			ppm->sync = false;
+		}
+		// If on Last Channel
+		if (ppm->ch >= PPM_CH_NUM)
+		{
+			// Publish the frame and fill the other buffer next
+			ppm->rxTime[ppm->fill] = US_Read();
+			ppm->rxReady = ppm->fill;
+			ppm->fill ^= 1;
+			ppm->rxSeq++;
+			ppm->sync = false;
+
+			if (ppm->onFrame != NULL) { ppm->onFrame(); }
+		}
+
+	}
+
+	// Set variables for next loop
+	ppm->tick = now;
+
+}
+
+
+static void PPM_IRQ0 ( void )
+{
+	PPM_CH_IRQ(instances[0]);
+}
+
+#if PPM_INSTANCE_NUM >= 2
+static void PPM_IRQ1 ( void )
+{
+	PPM_CH_IRQ(instances[1]);
+}
+#endif
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -1,60 +1,111 @@
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#ifndef PPM_H
-#define PPM_H
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-#include "STM32X.h"
-
-#include "Core.h"
-#include "GPIO.h"
-#include "TIM.h"
-#include "US.h"
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-#define PPM_CH_NUM			8
-
-#define PPM_PERIOD			20
-#define PPM_MIN				1000
-#define PPM_CENTER			1500
-#define PPM_MAX				2000
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC TYPES      									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-typedef struct {
-	bool inputLost;
-	uint32_t ch[PPM_CH_NUM];
-} PPM_Data;
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-void 		PPM_Init 		( void );
-void 		PPM_Deinit 		( void );
-bool 		PPM_Detect 		( void );
-void 		PPM_Update 		( void );
-
-PPM_Data*	PPM_getDataPtr	( void );
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EXTERN DECLARATIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#endif /* PPM_H */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef PPM_H
+#define PPM_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "STM32X.h"
+
+#include "Core.h"
+#include "GPIO.h"
+#include "TIM.h"
+#include "US.h"
+#include "Timebase.h"
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#define PPM_CH_NUM			8
+
+#define PPM_PERIOD			20
+#define PPM_DETECT_MS		(PPM_PERIOD * 6)	// Listen window during detection
+#define PPM_MIN				1000
+#define PPM_CENTER			1500
+#define PPM_MAX				2000
+
+#ifndef PPM_INSTANCE_NUM
+#define PPM_INSTANCE_NUM	2		// Receivers that can run at once, each takes a pin interrupt handler
+#endif
+#if PPM_INSTANCE_NUM > 2
+#error "PPM_INSTANCE_NUM cannot be greater than 2"
+#endif
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+typedef struct {
+	bool inputLost;
+	uint16_t ch[PPM_CH_NUM];
+} PPM_Data;
+
+/*
+ * One PPM receiver, bound to an input pin and timer by PPM_Init().
+ * Only the PPM_* functions touch it.
+ */
+typedef struct {
+	uint32_t pin;
+	TIM_t * tim;
+	uint8_t slot;							// Pin interrupt handler in use
+
+	// Double buffer - the IRQ fills one while the other holds the last complete frame
+	volatile uint16_t rx[2][PPM_CH_NUM];
+	volatile uint8_t rxReady;				// Buffer holding the last complete frame
+	volatile uint32_t rxSeq;				// Incremented by the IRQ for each complete frame
+	volatile uint32_t rxTime[2];			// US_Read() at the last edge of each buffer's frame
+
+	// Pulse train state - owned by the IRQ
+	uint32_t tick;							// Previous IRQ loop time
+	uint8_t ch;								// Channel index
+	bool sync;								// Sync flag to indicate start of transmission
+	uint8_t fill;							// Buffer being filled, never rxReady
+
+	PPM_Data data;
+#ifdef RADIO_USE_HIRES
+	uint16_t raw[PPM_CH_NUM];				// Channel values as received
+	int16_t norm[PPM_CH_NUM];				// Q15 of the raw values, 0 where data.ch is 0
+#endif
+	uint32_t frameCount;
+	uint32_t frameTime;
+	TIMEBASE_rate_t rate;					// Frame rate, sets the failsafe timeout
+	void (*onFrame)(void);
+} PPM_t;
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+bool 		PPM_Init 			( PPM_t *, uint32_t, TIM_t * );
+void 		PPM_Deinit 			( PPM_t * );
+bool 		PPM_Detect 			( PPM_t * );
+void 		PPM_Update 			( PPM_t * );
+
+uint16_t*	PPM_getData			( PPM_t * );
+#ifdef RADIO_USE_HIRES
+int16_t*	PPM_getNormalised	( PPM_t * );
+uint16_t*	PPM_getRaw				( PPM_t * );
+#endif
+uint32_t	PPM_getInputLost	( PPM_t * );
+uint32_t	PPM_getFrameCount	( PPM_t * );
+uint32_t	PPM_getFrameTime	( PPM_t * );
+uint8_t		PPM_getLinkQuality	( PPM_t * );
+void 		PPM_OnFrame		( PPM_t *, void (*)(void) );
+PPM_Data*	PPM_getDataPtr		( PPM_t * );
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* PPM_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -1,341 +1,530 @@
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#include "PWM.h"
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#define PWM_DETECT_MS	(PWM_TIMEIN_CYCLES * PWM_PERIOD_MAX_MS * 2)
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE TYPES										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-typedef struct {
-    uint32_t	pin;
-    void 		(*irqHandler)(void);
-} PWM_channels_t;
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE PROTOTYPES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-static void PWM_Process ( RADIO_chIndex_t );
-
-static void PWM_IRQ 	( RADIO_chIndex_t );
-static void PWM_CH1_IRQ ( void );
-#if PWM_CH_NUM >= 2
-static void PWM_CH2_IRQ ( void );
-#endif
-#if PWM_CH_NUM >= 3
-static void PWM_CH3_IRQ ( void );
-#endif
-#if PWM_CH_NUM >= 4
-static void PWM_CH4_IRQ ( void );
-#endif
-#if PWM_CH_NUM > 4
-#error // Too Many Channels Defined
-#endif
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE VARIABLES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-static const PWM_channels_t pwmCh[PWM_CH_NUM] = {	{ PWM_CH1_Pin, PWM_CH1_IRQ },
-#if PWM_CH_NUM >= 2
-													{ PWM_CH2_Pin, PWM_CH2_IRQ },
-#endif
-#if PWM_CH_NUM >= 3
-													{ PWM_CH3_Pin, PWM_CH3_IRQ },
-#endif
-#if PWM_CH_NUM >= 4
-													{ PWM_CH4_Pin, PWM_CH4_IRQ },
-#endif
-};
-
-static volatile uint32_t	rx[ PWM_CH_NUM ];
-uint32_t    				ch[ PWM_CH_NUM ];
-bool    					chFault[ PWM_CH_NUM ];
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * PWM_Init
- *  -
- */
-void PWM_Init ( void )
-{
-	// RESET RADIO DATA ARRAYS
-	for (uint8_t c = 0; c < PWM_CH_NUM; c++) {
-		rx[c] = 0;
-		ch[c] = 0;
-		chFault[c] = true;
-	}
-
-	// START TIMER TO MEASURE PULSE WIDTHS
-	TIM_Init(  PWM_TIM, PWM_TIM_FREQ, PWM_TIM_RELOAD );
-	TIM_Start( PWM_TIM );
-
-	// CONFIGURE EACH INPUT PIN AND ASSIGN IRQ
-	for ( uint8_t c = 0; c < PWM_CH_NUM; c++ ) {
-		GPIO_EnableInput( pwmCh[c].pin, GPIO_Pull_Down);
-		GPIO_OnChange( pwmCh[c].pin, GPIO_IT_Both, pwmCh[c].irqHandler );
-	}
-
-	// RUN A PWM DATA UPDATE BEFORE PROGRESSING
-	PWM_Update();
-}
-
-
-/*
- * PWM_Deinit
- *  -
- */
-void PWM_Deinit ( void )
-{
-	// STOP AND DEINITIALISE THE RADIO TIMER
-	TIM_Deinit(PWM_TIM);
-
-	// DEINITIALISE AND UNASIGN IRQ FOR EACH RADIO INPUT PIN
-	for ( uint8_t c = 0; c < PWM_CH_NUM; c++ ) {
-		GPIO_OnChange( pwmCh[c].pin, GPIO_IT_None, NULL );
-		GPIO_Deinit( pwmCh[c].pin );
-	}
-}
-
-
-/*
- * PWM_Detect
- *  -
- */
-bool PWM_Detect ( void )
-{
-	// INITIALSIE FUNCTION VARIABLES
-	uint32_t tick = CORE_GetTick();
-
-	// RUN PWM PROTOCOL DETECTION
-	PWM_Init();
-	while ( PWM_DETECT_MS > (CORE_GetTick() - tick) )
-	{
-		// comment
-		PWM_Update();
-
-		//
-		bool noFaults = true;
-		for ( uint8_t c = 0; c < PWM_CH_NUM; c++ ) {
-			if ( chFault[c] ) {
-				noFaults = false;
-				break;
-			}
-		}
-
-		//
-		if ( noFaults ) {
-			return true;
-		}
-
-		CORE_Idle();
-	}
-
-	// DEINITIALISE IF NO RADIO DETECTED
-	PWM_Deinit();
-	return false;
-}
-
-
-/*
- * PWM_Update
- *  -
- */
-void PWM_Update ( void )
-{
-	// INITIALISE FUCNTION VARIABLES
-	static uint32_t tick[ PWM_CH_NUM ] 		= {0};
-	static uint8_t 	validCount[ PWM_CH_NUM ]	= {0};
-	uint32_t 		now 					= CORE_GetTick();
-
-	// ITTERATE THROUGH EACH CHANNEL
-	for ( uint8_t c = 0; c < PWM_CH_NUM; c++ )
-	{
-		// STATE - TIMEDOUT (OR STARTUP)
-		if ( chFault[c] )
-		{
-			// CHECK FOR DATA IN THE RECIEVE BUFFER
-			if ( rx[c] ) {
-				// HAVE WE REACHED TIME IN CONDITION
-				if ( ++validCount[c] >= PWM_TIMEIN_CYCLES ) {
-					// RESET FAULT FLAG AND PROCEED TO NORMAL OPERATION - DONT RESET RX ARRAY
-					chFault[c] = false;
-				} else {
-					// RESET DATA FOR NEXT LOOP
-					rx[c] = 0;
-					tick[c] = now;
-				}
-			}
-			// CHECK FOR TIMEIN COUNT RESET
-			else if ( validCount[c] && (now - tick[c] >= PWM_PERIOD_MAX_MS) ) {
-				validCount[c] = 0;
-				tick[c] = now;
-			}
-		}
-
-		// STATE - NORMAL OPERATION
-		if ( !chFault[c] )
-		{
-			// CHECK FOR NEW DATA
-			if ( rx[c] )
-			{
-				// PROCESS DATA
-				PWM_Process(c);
-				// RESET RELEVANT FLAGS
-				tick[c] = now;
-			}
-
-			// CHECK FOR TIMEOUT CONDITION
-			else if ( now - tick[c] >= PWM_TIMEOUT_MS )
-			{
-				// SET RELEVANT FLAGS
-				chFault[c] = true;
-				ch[c] = 0;
-				tick[c] = now;
-				validCount[c] = 0;
-			}
-		}
-	}
-}
-
-
-/*
- * PWM_getData
- *  -
- */
-uint32_t* PWM_getData ( void )
-{
-	return ch;
-}
-
-
-/*
- * PWM_getInputLost
- *  -
- */
-bool* PWM_getInputLost ( void )
-{
-	return chFault;
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE FUNCTIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * PWM_Process
- *  -
- */
-static void PWM_Process ( RADIO_chIndex_t c )
-{
-	// EXTRACT DATA AND RESET TEMP ARRAY
-	uint32_t pulse = rx[c];
-	rx[c] = 0;
-
-	// TRUNCATE RADIO DATA AND MOVE TO OUTBOUND ARRAY
-	// WE ALREADY KNOW DATA IS GREATER THAN RADIO_CH_ABSMIN AND SMALLER THAN RADIO_CH_ABSMAX
-	if ( pulse < RADIO_CH_MIN ) {
-		ch[c] = RADIO_CH_MIN;
-	}
-	else if ( pulse > RADIO_CH_MAX ) {
-		ch[c] = RADIO_CH_MAX;
-	}
-	else {
-		ch[c] = pulse;
-	}
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EVENT HANDLERS   									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* INTERRUPT ROUTINES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * PWM_IRQ
- *  -
- */
-static void PWM_IRQ ( RADIO_chIndex_t c )
-{
-	// INITIALISE LOOP VARIABLES
-	uint32_t 		now 					= TIM_Read(  PWM_TIM);
-	bool 			pos 					= GPIO_Read( pwmCh[c].pin );
-	static bool 	pos_p[PWM_CH_NUM]		= { false };
-	static uint32_t	tickHigh[PWM_CH_NUM] 	= {0};
-	static uint32_t	tickLow[PWM_CH_NUM] 	= {0};
-
-	// IGNORE NOISE ON SIGNAL I/P THAT RETURNS FASTER THAN INTERRRUPT SERVICE
-	if ( pos != pos_p[c] )
-	{
-		// RISING EDGE PULSE DETECTED
-		if ( pos ) {
-			// ASSIGN VARIABLES TO USE ON PULSE LOW
-			tickHigh[c] = now;
-		}
-		// FALLING EDGE PULSE DETECTED
-		else {
-			// CALCULATE SIGNAL PERIOD AND PULSE WIDTH
-			uint32_t period = now - tickLow[c];
-			uint32_t pulse = now - tickHigh[c];
-			// CHECK SIGNAL IS VALID
-			if ( pulse <= RADIO_CH_ABSMAX 		&& pulse >= RADIO_CH_ABSMIN &&
-				 period <= PWM_PERIOD_MAX_US	&& period >= PWM_PERIOD_MIN_US )
-			{
-				// ASSIGN PULSE TO TEMP DATA ARRAY
-				rx[c] = pulse;
-			}
-			// UPDATE VARIABLES FOR NEXT LOOP
-			tickLow[c] = now;
-		}
-
-		//
-		pos_p[c] = pos;
-	}
-}
-
-
-static void PWM_CH1_IRQ(void)
-{
-	PWM_IRQ(CH1);
-}
-
-#if PWM_CH_NUM >= 2
-static void PWM_CH2_IRQ(void)
-{
-	PWM_IRQ(CH2);
-}
-#endif
-
-#if PWM_CH_NUM >= 3
-static void PWM_CH3_IRQ(void)
-{
-	PWM_IRQ(CH3);
-}
-#endif
-
-#if PWM_CH_NUM >= 4
-static void PWM_CH4_IRQ(void)
-{
-	PWM_IRQ(CH4);
-}
-#endif
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "PWM.h"
+#include "Radio.h"
+
+#ifndef RADIO_NO_PWM
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+// IRQ samples are published as a single word - (sequence << 16) | pulse width
+#define PWM_SEQ_SHIFT		16
+#define PWM_PULSE_MASK		0xFFFF
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static void 		PWM_Process 			( PWM_t *, RADIO_chIndex_t, uint32_t );
+
+static bool 		PWM_opsInit				( void *, uint32_t, bool );
+static void 		PWM_opsDeinit			( void * );
+static bool 		PWM_opsDetect			( void * );
+static void 		PWM_opsUpdate			( void * );
+static uint16_t*	PWM_opsGetData			( void * );
+#ifdef RADIO_USE_HIRES
+static int16_t*	PWM_opsGetNormalised	( void * );
+static uint16_t*	PWM_opsGetRaw			( void * );
+#endif
+static uint32_t		PWM_opsGetInputLost		( void * );
+static uint32_t		PWM_opsGetFrameCount	( void * );
+static uint32_t		PWM_opsGetFrameTime		( void * );
+static uint8_t		PWM_opsGetLinkQuality	( void * );
+static void 		PWM_opsOnFrame			( void *, void (*)(void) );
+
+static void 		PWM_IRQ 				( PWM_t * );
+static void 		PWM_IRQ0 				( void );
+#if PWM_INSTANCE_NUM >= 2
+static void 		PWM_IRQ1 				( void );
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+// Pins of the Radio.c input
+static const uint32_t pwmPins[PWM_CH_NUM] = {	PWM_CH1_Pin,
+#if PWM_CH_NUM >= 2
+												PWM_CH2_Pin,
+#endif
+#if PWM_CH_NUM >= 3
+												PWM_CH3_Pin,
+#endif
+#if PWM_CH_NUM >= 4
+												PWM_CH4_Pin,
+#endif
+};
+
+// Receiver using each pin interrupt handler. GPIO_OnChange() handlers take no arguments.
+static PWM_t * 				instances[ PWM_INSTANCE_NUM ];
+static void 				( * const irqHandler[ PWM_INSTANCE_NUM ] )( void ) = {
+	PWM_IRQ0,
+#if PWM_INSTANCE_NUM >= 2
+	PWM_IRQ1,
+#endif
+};
+
+/* Dispatch table for Radio.c, which keeps a PWM_t per input */
+const RADIO_ops_t PWM_ops = {
+	.chCount		= PWM_CH_NUM,
+	.init			= PWM_opsInit,
+	.deinit			= PWM_opsDeinit,
+	.detect			= PWM_opsDetect,
+	.update			= PWM_opsUpdate,
+	.getData		= PWM_opsGetData,
+#ifdef RADIO_USE_HIRES
+	.getNormalised	= PWM_opsGetNormalised,
+	.getRaw			= PWM_opsGetRaw,
+#endif
+	.getInputLost	= PWM_opsGetInputLost,
+	.getFrameCount	= PWM_opsGetFrameCount,
+	.getLinkQuality	= PWM_opsGetLinkQuality,
+	.getFrameTime	= PWM_opsGetFrameTime,
+	.onFrame		= PWM_opsOnFrame,
+};
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * PWM_Init
+ *  - Binds the receiver to PWM_CH_NUM input pins and a free running timer, and starts it.
+ *    Each receiver needs its own timer. Clears any callback, so PWM_OnFrame() goes after this.
+ *  - Returns false if PWM_INSTANCE_NUM receivers are already running.
+ */
+bool PWM_Init ( PWM_t * pwm, const uint32_t * pins, TIM_t * tim )
+{
+	// CLAIM A PIN INTERRUPT HANDLER
+	uint8_t slot = 0;
+	while ( slot < PWM_INSTANCE_NUM && instances[slot] != NULL && instances[slot] != pwm ) {
+		slot++;
+	}
+	if ( slot >= PWM_INSTANCE_NUM ) {
+		return false;
+	}
+
+	// RESET RADIO DATA ARRAYS
+	memset( pwm, 0, sizeof(*pwm) );
+	pwm->tim		= tim;
+	pwm->slot		= slot;
+	pwm->chFault	= RADIO_CH_MASK(PWM_CH_NUM);
+	TIMEBASE_RateInit( &pwm->rate, PWM_TIMEOUT_US );
+	for ( uint8_t c = 0; c < PWM_CH_NUM; c++ ) {
+		pwm->pin[c]	= pins[c];
+	}
+	instances[slot] = pwm;
+
+	// START TIMER TO MEASURE PULSE WIDTHS
+	TIM_Init(  tim, PWM_TIM_FREQ, PWM_TIM_RELOAD );
+	TIM_Start( tim );
+
+	// CONFIGURE EACH INPUT PIN AND ASSIGN IRQ
+	for ( uint8_t c = 0; c < PWM_CH_NUM; c++ ) {
+		GPIO_EnableInput( pwm->pin[c], GPIO_Pull_Down);
+		GPIO_OnChange( pwm->pin[c], GPIO_IT_Both, irqHandler[slot] );
+	}
+
+	// RUN A PWM DATA UPDATE BEFORE PROGRESSING
+	PWM_Update( pwm );
+
+	return true;
+}
+
+
+/*
+ * PWM_Deinit
+ *  - Stops the receiver and releases its pin interrupt handler.
+ */
+void PWM_Deinit ( PWM_t * pwm )
+{
+	// STOP AND DEINITIALISE THE RADIO TIMER
+	TIM_Deinit( pwm->tim );
+
+	// DEINITIALISE AND UNASIGN IRQ FOR EACH RADIO INPUT PIN
+	for ( uint8_t c = 0; c < PWM_CH_NUM; c++ ) {
+		GPIO_OnChange( pwm->pin[c], GPIO_IT_None, NULL );
+		GPIO_Deinit( pwm->pin[c] );
+	}
+
+	instances[pwm->slot] = NULL;
+}
+
+
+/*
+ * PWM_Detect
+ *  - Non-blocking. Call after PWM_Update() during detection.
+ *  - Returns true once every channel has timed in.
+ */
+bool PWM_Detect ( PWM_t * pwm )
+{
+	return pwm->chFault == 0;
+}
+
+
+/*
+ * PWM_Update
+ *  -
+ */
+void PWM_Update ( PWM_t * pwm )
+{
+	// INITIALISE FUCNTION VARIABLES
+	uint32_t 		now 					= TIMEBASE_Now();
+
+	// ITTERATE THROUGH EACH CHANNEL
+	for ( uint8_t c = 0; c < PWM_CH_NUM; c++ )
+	{
+		// TAKE THE LATEST SAMPLE - NEW IF THE IRQ HAS MOVED THE SEQUENCE ON
+		uint32_t sample = pwm->rx[c];
+		uint16_t seq 	= sample >> PWM_SEQ_SHIFT;
+		bool fresh		= ( seq != pwm->rxSeen[c] );
+		pwm->rxSeen[c] 	= seq;
+
+		// STATE - TIMEDOUT (OR STARTUP)
+		if ( pwm->chFault & (1 << c) )
+		{
+			// CHECK FOR A NEW SAMPLE
+			if ( fresh ) {
+				// HAVE WE REACHED TIME IN CONDITION
+				if ( ++pwm->validCount[c] >= PWM_TIMEIN_CYCLES ) {
+					// RESET FAULT FLAG AND PROCEED TO NORMAL OPERATION WITH THIS SAMPLE
+					pwm->chFault &= ~(1 << c);
+				} else {
+					pwm->tick[c] = now;
+				}
+			}
+			// CHECK FOR TIMEIN COUNT RESET
+			else if ( pwm->validCount[c] && (now - pwm->tick[c] >= PWM_PERIOD_MAX_US) ) {
+				pwm->validCount[c] = 0;
+				pwm->tick[c] = now;
+			}
+		}
+
+		// STATE - NORMAL OPERATION
+		if ( !(pwm->chFault & (1 << c)) )
+		{
+			// CHECK FOR NEW DATA
+			if ( fresh )
+			{
+				// CH1 PULSES GIVE THE FRAME RATE, THE OTHERS ARE STAGGERED IN THE SAME FRAME
+				if ( c == CH1 ) {
+					TIMEBASE_RateFrame( &pwm->rate, pwm->rxTime[c], 1 );
+					pwm->periodTime = pwm->rxTime[c];
+					pwm->periodCount++;
+				}
+				// PROCESS DATA
+				PWM_Process( pwm, c, sample & PWM_PULSE_MASK );
+				// RESET RELEVANT FLAGS
+				pwm->tick[c] = now;
+			}
+
+			// CHECK FOR TIMEOUT CONDITION
+			else if ( now - pwm->tick[c] >= TIMEBASE_RateTimeout( &pwm->rate ) )
+			{
+				// SET RELEVANT FLAGS
+				pwm->chFault |= (1 << c);
+				pwm->ch[c] = 0;
+#ifdef RADIO_USE_HIRES
+				pwm->norm[c] = 0;
+#endif
+				pwm->tick[c] = now;
+				pwm->validCount[c] = 0;
+			}
+		}
+	}
+}
+
+
+/*
+ * PWM_getData
+ *  -
+ */
+uint16_t* PWM_getData ( PWM_t * pwm )
+{
+	return pwm->ch;
+}
+
+#ifdef RADIO_USE_HIRES
+/*
+ * PWM_getNormalised
+ *  - Channels as Q15, +-32767 for 1000-2000us.
+ */
+int16_t* PWM_getNormalised ( PWM_t * pwm )
+{
+	return pwm->norm;
+}
+
+
+/*
+ * PWM_getRaw
+ *  - Pulse widths as measured, before bounding.
+ */
+uint16_t* PWM_getRaw ( PWM_t * pwm )
+{
+	return pwm->raw;
+}
+#endif
+
+
+/*
+ * PWM_getInputLost
+ *  - Bit per channel, set while the channel is timed out.
+ */
+uint32_t PWM_getInputLost ( PWM_t * pwm )
+{
+	return pwm->chFault;
+}
+
+
+/*
+ * PWM_getFrameCount
+ *  - Incremented for every pulse processed on any channel. Wraps.
+ */
+uint32_t PWM_getFrameCount ( PWM_t * pwm )
+{
+	return pwm->frameCount;
+}
+
+/*
+ * PWM_getFrameTime
+ *  - US_Read() timestamp of the falling edge of the last pulse processed on any channel.
+ */
+uint32_t PWM_getFrameTime ( PWM_t * pwm )
+{
+	return pwm->frameTime;
+}
+
+
+/*
+ * PWM_getPeriodCount
+ *  - Incremented for every CH1 pulse processed, so once per PWM period. Wraps.
+ */
+uint32_t PWM_getPeriodCount ( PWM_t * pwm )
+{
+	return pwm->periodCount;
+}
+
+/*
+ * PWM_getPeriodTime
+ *  - US_Read() timestamp of the falling edge of the last CH1 pulse processed.
+ */
+uint32_t PWM_getPeriodTime ( PWM_t * pwm )
+{
+	return pwm->periodTime;
+}
+
+
+/*
+ * PWM_getUpdated
+ *  - Bit per channel with a pulse processed since the last call, which clears them.
+ */
+uint32_t PWM_getUpdated ( PWM_t * pwm )
+{
+	uint32_t updated = pwm->chUpdated;
+	pwm->chUpdated = 0;
+	return updated;
+}
+
+
+/*
+ * PWM_getLinkQuality
+ *  - Percentage of channels currently valid.
+ */
+uint8_t PWM_getLinkQuality ( PWM_t * pwm )
+{
+	uint8_t valid = PWM_CH_NUM - __builtin_popcount( pwm->chFault );
+	return (valid * 100) / PWM_CH_NUM;
+}
+
+/*
+ * PWM_OnFrame
+ *  - Registers a callback fired from interrupt context as soon as any channel receives a valid pulse.
+ *  - Pass NULL to remove.
+ */
+void PWM_OnFrame ( PWM_t * pwm, void (*callback)(void) )
+{
+	pwm->onFrame = callback;
+}
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * PWM_Process
+ *  -
+ */
+static void PWM_Process ( PWM_t * pwm, RADIO_chIndex_t c, uint32_t pulse )
+{
+	// TRUNCATE RADIO DATA AND MOVE TO OUTBOUND ARRAY
+	// WE ALREADY KNOW DATA IS GREATER THAN RADIO_CH_ABSMIN AND SMALLER THAN RADIO_CH_ABSMAX
+	if ( pulse < RADIO_CH_MIN ) {
+		pwm->ch[c] = RADIO_CH_MIN;
+	}
+	else if ( pulse > RADIO_CH_MAX ) {
+		pwm->ch[c] = RADIO_CH_MAX;
+	}
+	else {
+		pwm->ch[c] = pulse;
+	}
+#ifdef RADIO_USE_HIRES
+	pwm->raw[c]  = pulse;
+	pwm->norm[c] = RADIO_Q15( pwm->ch[c], RADIO_CH_MIN, RADIO_CH_MAX );
+#endif
+
+	pwm->frameTime = pwm->rxTime[c];
+	pwm->frameCount++;
+	pwm->chUpdated |= 1UL << c;
+}
+
+/*
+ * PWM_ops entries
+ *  - ctx is the PWM_t of the Radio.c input, which is bound to the PWM_CHx_Pin pins and PWM_TIM.
+ *  - Not a serial protocol, so the line settings are unused.
+ */
+static bool PWM_opsInit ( void * ctx, uint32_t baud, bool inverted )
+{
+	(void)baud;
+	(void)inverted;
+	return PWM_Init( ctx, pwmPins, PWM_TIM );
+}
+
+static void PWM_opsDeinit ( void * ctx )
+{
+	PWM_Deinit( ctx );
+}
+
+static bool PWM_opsDetect ( void * ctx )
+{
+	return PWM_Detect( ctx );
+}
+
+static void PWM_opsUpdate ( void * ctx )
+{
+	PWM_Update( ctx );
+}
+
+static uint16_t* PWM_opsGetData ( void * ctx )
+{
+	return PWM_getData( ctx );
+}
+
+#ifdef RADIO_USE_HIRES
+static int16_t* PWM_opsGetNormalised ( void * ctx )
+{
+	return PWM_getNormalised( ctx );
+}
+
+static uint16_t* PWM_opsGetRaw ( void * ctx )
+{
+	return PWM_getRaw( ctx );
+}
+#endif
+
+static uint32_t PWM_opsGetInputLost ( void * ctx )
+{
+	return PWM_getInputLost( ctx );
+}
+
+static uint32_t PWM_opsGetFrameCount ( void * ctx )
+{
+	return PWM_getFrameCount( ctx );
+}
+
+static uint32_t PWM_opsGetFrameTime ( void * ctx )
+{
+	return PWM_getFrameTime( ctx );
+}
+
+static uint8_t PWM_opsGetLinkQuality ( void * ctx )
+{
+	return PWM_getLinkQuality( ctx );
+}
+
+static void PWM_opsOnFrame ( void * ctx, void (*callback)(void) )
+{
+	PWM_OnFrame( ctx, callback );
+}
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS   									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * PWM_IRQ
+ *  - Either edge on any of the receiver's pins. Every channel whose level has
+ *    changed is handled, so one handler serves all the pins of a receiver.
+ */
+static void PWM_IRQ ( PWM_t * pwm )
+{
+	// INITIALISE LOOP VARIABLES
+	uint32_t 		now 					= TIM_Read( pwm->tim );
+
+	for ( uint8_t c = 0; c < PWM_CH_NUM; c++ )
+	{
+		bool pos = GPIO_Read( pwm->pin[c] );
+
+		// IGNORE CHANNELS WITHOUT AN EDGE, AND NOISE THAT RETURNS FASTER THAN INTERRRUPT SERVICE
+		if ( pos == pwm->pos_p[c] ) { continue; }
+
+		// RISING EDGE PULSE DETECTED
+		if ( pos ) {
+			// ASSIGN VARIABLES TO USE ON PULSE LOW
+			pwm->tickHigh[c] = now;
+		}
+		// FALLING EDGE PULSE DETECTED
+		else {
+			// CALCULATE SIGNAL PERIOD AND PULSE WIDTH
+			uint32_t period = now - pwm->tickLow[c];
+			uint32_t pulse = now - pwm->tickHigh[c];
+			// CHECK SIGNAL IS VALID
+			if ( pulse <= RADIO_CH_ABSMAX 		&& pulse >= RADIO_CH_ABSMIN &&
+				 period <= PWM_PERIOD_MAX_US	&& period >= PWM_PERIOD_MIN_US )
+			{
+				// PUBLISH PULSE AND SEQUENCE IN ONE WRITE
+				pwm->rxTime[c] = US_Read();
+				pwm->seq[c]++;
+				pwm->rx[c] = ((uint32_t)pwm->seq[c] << PWM_SEQ_SHIFT) | pulse;
+				if ( pwm->onFrame != NULL ) { pwm->onFrame(); }
+			}
+			// UPDATE VARIABLES FOR NEXT LOOP
+			pwm->tickLow[c] = now;
+		}
+
+		//
+		pwm->pos_p[c] = pos;
+	}
+}
+
+
+static void PWM_IRQ0(void)
+{
+	PWM_IRQ( instances[0] );
+}
+
+#if PWM_INSTANCE_NUM >= 2
+static void PWM_IRQ1(void)
+{
+	PWM_IRQ( instances[1] );
+}
+#endif
+
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -1,68 +1,129 @@
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#ifndef PWM_H
-#define PWM_H
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#include "STM32X.h"
-
-#include "Radio.h"
-#include "Core.h"
-#include "GPIO.h"
-#include "TIM.h"
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#ifdef PWM_CH_NUM
-#if PWM_CH_NUM > 4
-#error "PWM_CH_NUM cannot be greater than 4"
-#endif
-#elif defined(PWM_CH1_Pin) && defined(PWM_CH2_Pin) && defined(PWM_CH3_Pin) && defined(PWM_CH4_Pin)
-#define PWM_CH_NUM	4
-#elif defined(PWM_CH1_Pin) && defined(PWM_CH2_Pin) && defined(PWM_CH3_Pin)
-#define PWM_CH_NUM	3
-#elif defined(PWM_CH1_Pin) && defined(PWM_CH2_Pin)
-#define PWM_CH_NUM	2
-#elif defined(PWM_CH1_Pin)
-#define PWM_CH_NUM	1
-#else
-#error "error defining PWM_CH_NUM"
-#endif
-
-#define PWM_PERIOD_MS		20
-#define PWM_PERIOD_MAX_MS	25
-#define PWM_PERIOD_MAX_US 	(PWM_PERIOD_MAX_MS*1000)
-#define PWM_PERIOD_MIN_MS 	10
-#define PWM_PERIOD_MIN_US 	(PWM_PERIOD_MIN_MS*1000)
-#define PWM_PERIOD_US		(PWM_PERIOD_MS * 1000)
-
-#define PWM_TIMEOUT_CYCLES	5
-#define PWM_TIMEOUT_MS		(PWM_PERIOD_MAX_MS * PWM_TIMEOUT_CYCLES)
-
-#define PWM_TIMEIN_CYCLES	3
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC TYPES      									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-void 		PWM_Init 			( void );
-void 		PWM_Deinit			( void );
-bool 		PWM_Detect			( void );
-void 		PWM_Update			( void );
-
-uint32_t*	PWM_getData 		( void );
-bool* 		PWM_getInputLost	( void );
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EXTERN DECLARATIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#endif /* PWM_H */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef PWM_H
+#define PWM_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+#include "Core.h"
+#include "GPIO.h"
+#include "TIM.h"
+#include "US.h"
+#include "Timebase.h"
+
+#ifndef RADIO_NO_PWM
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifdef PWM_CH_NUM
+#if PWM_CH_NUM > 4
+#error "PWM_CH_NUM cannot be greater than 4"
+#endif
+#elif defined(PWM_CH1_Pin) && defined(PWM_CH2_Pin) && defined(PWM_CH3_Pin) && defined(PWM_CH4_Pin)
+#define PWM_CH_NUM	4
+#elif defined(PWM_CH1_Pin) && defined(PWM_CH2_Pin) && defined(PWM_CH3_Pin)
+#define PWM_CH_NUM	3
+#elif defined(PWM_CH1_Pin) && defined(PWM_CH2_Pin)
+#define PWM_CH_NUM	2
+#elif defined(PWM_CH1_Pin)
+#define PWM_CH_NUM	1
+#else
+#error "error defining PWM_CH_NUM"
+#endif
+
+#define PWM_PERIOD_MS		20
+#define PWM_PERIOD_MAX_MS	25
+#define PWM_PERIOD_MAX_US 	(PWM_PERIOD_MAX_MS*1000)
+#define PWM_PERIOD_MIN_MS 	10
+#define PWM_PERIOD_MIN_US 	(PWM_PERIOD_MIN_MS*1000)
+#define PWM_PERIOD_US		(PWM_PERIOD_MS * 1000)
+
+#define PWM_TIMEOUT_CYCLES	5
+#define PWM_TIMEOUT_MS		(PWM_PERIOD_MAX_MS * PWM_TIMEOUT_CYCLES)
+#define PWM_TIMEOUT_US		TIMEBASE_MS(PWM_TIMEOUT_MS)
+
+#define PWM_TIMEIN_CYCLES	3
+
+#define PWM_DETECT_MS		(PWM_TIMEIN_CYCLES * PWM_PERIOD_MAX_MS * 2)
+
+#ifndef PWM_INSTANCE_NUM
+#define PWM_INSTANCE_NUM	2		// Receivers that can run at once, each takes a pin interrupt handler
+#endif
+#if PWM_INSTANCE_NUM > 2
+#error "PWM_INSTANCE_NUM cannot be greater than 2"
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* One PWM receiver, bound to PWM_CH_NUM input pins and a timer by PWM_Init(). Only the PWM_* functions touch it */
+typedef struct {
+	TIM_t *				tim;
+	uint32_t			pin[ PWM_CH_NUM ];
+	uint8_t				slot;						// Pin interrupt handler in use
+
+	volatile uint32_t	rx[ PWM_CH_NUM ];			// (sequence << 16) | pulse width, from the IRQ
+	volatile uint32_t	rxTime[ PWM_CH_NUM ];		// US_Read() at each channel's last falling edge
+	uint16_t			rxSeen[ PWM_CH_NUM ];
+
+	// Edge state - owned by the IRQ
+	bool 				pos_p[ PWM_CH_NUM ];
+	uint32_t			tickHigh[ PWM_CH_NUM ];
+	uint32_t			tickLow[ PWM_CH_NUM ];
+	uint16_t			seq[ PWM_CH_NUM ];
+
+	// Time in / time out state - owned by PWM_Update()
+	uint32_t			tick[ PWM_CH_NUM ];
+	uint8_t				validCount[ PWM_CH_NUM ];
+
+	uint16_t			ch[ PWM_CH_NUM ];
+#ifdef RADIO_USE_HIRES
+	uint16_t			raw[ PWM_CH_NUM ];			// Pulse widths as measured
+	int16_t				norm[ PWM_CH_NUM ];			// Q15 of the pulse widths, 0 where ch is 0
+#endif
+	uint32_t			chFault;					// Bit per channel, set while it is timed out
+	uint32_t			chUpdated;					// Bit per channel with a pulse since PWM_getUpdated()
+	uint32_t			frameCount;
+	uint32_t			frameTime;
+	uint32_t			periodCount;				// CH1 pulses processed, one per PWM period
+	uint32_t			periodTime;					// US_Read() at the falling edge of the last of them
+	TIMEBASE_rate_t		rate;						// CH1 pulse rate, sets the timeout of every channel
+	void 				( *onFrame )( void );
+} PWM_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+bool 		PWM_Init 			( PWM_t *, const uint32_t *, TIM_t * );
+void 		PWM_Deinit			( PWM_t * );
+bool 		PWM_Detect			( PWM_t * );
+void 		PWM_Update			( PWM_t * );
+
+uint16_t*	PWM_getData 		( PWM_t * );
+#ifdef RADIO_USE_HIRES
+int16_t*	PWM_getNormalised	( PWM_t * );
+uint16_t*	PWM_getRaw 			( PWM_t * );
+#endif
+uint32_t	PWM_getInputLost	( PWM_t * );
+uint32_t	PWM_getFrameCount	( PWM_t * );
+uint32_t	PWM_getFrameTime	( PWM_t * );
+uint32_t	PWM_getPeriodCount	( PWM_t * );
+uint32_t	PWM_getPeriodTime	( PWM_t * );
+uint32_t	PWM_getUpdated		( PWM_t * );
+uint8_t		PWM_getLinkQuality	( PWM_t * );
+void 		PWM_OnFrame		( PWM_t *, void (*)(void) );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#endif /* RADIO_NO_PWM */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* PWM_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
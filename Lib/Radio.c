@@ -1,382 +1,1649 @@
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#include "Radio.h"
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#define RADIO_DETECT_TIMEOUT_MS   	1000	/* How long (ms) to wait for frames when trying a protocol */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE TYPES										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* “v‑table” of the five functions every protocol must provide */
-typedef struct {
-	bool 				initialised;
-	RADIO_protocol_t 	protocol;
-    uint8_t				chCount;
-    RADIO_chActive_t	chActiveCount[RADIO_CH_NUM_MAX];
-    uint8_t 			chValidCount;
-    uint32_t*		( *getData )( void );
-    bool*			( *getInputLost )( void );
-} RADIO_ops;
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE PROTOTYPES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-static inline bool RADIO_tryProtocol ( RADIO_protocol_t );
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE VARIABLES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-static RADIO_ops ops;
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * RADIO_Init
- *  - Attempts to use 'initial' protocol first.
- *  - If no valid input appears, cycles through all other enabled protocols.
- *  - If still none succeed, falls back to 'initial'.
- *  - Returns the protocol actually in use.
- */
-RADIO_protocol_t RADIO_Init ( RADIO_protocol_t initial )
-{
-	ops.initialised = true;
-
-	if ( RADIO_tryProtocol(initial) )
-	{
-		return initial;
-	}
-
-	for ( RADIO_protocol_t p = 0; p < RADIO_NUM_PROTOCOL; p++ ) {
-		if ( p == initial ) { continue; }
-		if ( RADIO_tryProtocol(p) ) { return p; }
-	}
-
-	ops.protocol = initial;
-    switch (initial) {
-	#ifdef RADIO_USE_PPM
-    case PPM:
-		ops.chCount			= PPM_CH_NUM;
-    	ops.getData 		= PPM_getData;
-    	ops.getInputLost 	= PPM_getInputLost;
-    	PPM_Init();
-        break;
-	#endif
-	#ifdef RADIO_USE_IBUS
-    case IBUS;
-		ops.chCount			= IBUS_CH_NUM;
-    	ops.getData 		= IBUS_getData;
-    	ops.getInputLost 	= IBUS_getInputLost;
-    	IBUS_Init();
-        break;
-	#endif
-	#ifdef RADIO_USE_SBUS
-    case SBUS:
-		ops.chCount			= SBUS_CH_NUM;
-    	ops.getData 		= SBUS_getData;
-    	ops.getInputLost 	= SBUS_getInputLost;
-    	SBUS_Init();
-        break;
-	#endif
-	#ifdef RADIO_USE_CRSF
-    case CRSF:
-		ops.chCount			= CRSF_CH_NUM;
-    	ops.getData 		= CRSF_getData;
-    	ops.getInputLost 	= CRSF_getInputLost;
-    	CRSF_Init();
-        break;
-	#endif
-    case PWM:
-    default:
-		ops.chCount			= PWM_CH_NUM;
-    	ops.getData 		= PWM_getData;
-    	ops.getInputLost 	= PWM_getInputLost;
-    	PWM_Init();
-        break;
-    }
-    return initial;
-}
-
-/*
- * RADIO_Deinit
- *  -
- */
-void RADIO_Deinit ( void )
-{
-	ops.initialised = false;
-
-    switch (ops.protocol) {
-	#ifdef RADIO_USE_PPM
-    case PPM:
-    	PPM_Deinit();
-        break;
-	#endif
-	#ifdef RADIO_USE_IBUS
-    case IBUS;
-    	IBUS_Deinit();
-        break;
-	#endif
-	#ifdef RADIO_USE_SBUS
-    case SBUS:
-    	SBUS_Deinit();
-        break;
-	#endif
-	#ifdef RADIO_USE_CRSF
-    case CRSF:
-    	CRSF_Deinit();
-        break;
-	#endif
-    case PWM:
-    default:
-    	PWM_Deinit();
-        break;
-    }
-}
-
-/*
- * RADIO_Update
- *  - Poll this in your main loop (every ~1ms) to refresh channel data & fault flags.
- */
-void RADIO_Update ( void )
-{
-    switch (ops.protocol) {
-	#ifdef RADIO_USE_PPM
-    case PPM:
-    	PPM_Update();
-        break;
-	#endif
-	#ifdef RADIO_USE_IBUS
-    case IBUS;
-    	IBUS_Update();
-        break;
-	#endif
-	#ifdef RADIO_USE_SBUS
-    case SBUS:
-    	SBUS_Update();
-        break;
-	#endif
-	#ifdef RADIO_USE_CRSF
-    case CRSF:
-    	CRSF_Update();
-        break;
-	#endif
-    case PWM:
-    default:
-    	PWM_Update();
-        break;
-    }
-
-    // Update Active Channel Count
-    for ( uint8_t i = 0; i < ops.chCount; i++ ) {
-        if ( ops.getInputLost()[i] ) {
-            ops.chActiveCount[i] = chOFF;
-        } else if ( ops.getData()[i] > RADIO_CH_CENTERMAX ) {
-            ops.chActiveCount[i] = chFWD;
-        } else if ( ops.getData()[i] < RADIO_CH_CENTERMIN ) {
-            ops.chActiveCount[i] = chRVS;
-        } else {
-            ops.chActiveCount[i] = chOFF;
-        }
-    }
-
-    // Update Valid Channel Count
-	if ( ops.protocol == PWM ) {
-		uint8_t count = 0;
-		for ( uint8_t ch = CH1 ; ch < ops.chCount; ch++ ) {
-			count += !ops.getInputLost()[ch];
-		}
-		ops.chValidCount = count;
-	} else {
-		if ( ops.getInputLost() ) {
-			ops.chValidCount = ops.chCount;
-		} else {
-			ops.chValidCount = 0;
-		}
-	}
-}
-
-/*
- * RADIO_getDataPtr
- *  - After RADIO_Update(), use this to read ch[], inputLost, etc.
- */
-uint32_t* RADIO_getData ( void )
-{
-	if ( !ops.initialised ) { return NULL; }
-
-    switch (ops.protocol) {
-	#ifdef RADIO_USE_PPM
-    case PPM:
-    	return PPM_getData();
-	#endif
-	#ifdef RADIO_USE_IBUS
-    case IBUS;
-    	return IBUS_getData();
-	#endif
-	#ifdef RADIO_USE_SBUS
-    case SBUS:
-    	return SBUS_getData();
-	#endif
-	#ifdef RADIO_USE_CRSF
-    case CRSF:
-    	return CRSF_getData();
-	#endif
-    case PWM:
-    default:
-    	return PWM_getData();
-    }
-}
-
-/*
- * RADIO_getChCount
- *  -
- */
-uint8_t RADIO_getChCount ( void )
-{
-	if ( !ops.initialised ) { return 0; }
-
-    return ops.chCount;
-}
-
-/*
- * RADIO_getPtrChActive =
- */
-RADIO_chActive_t* RADIO_getChActiveCount ( void )
-{
-	if ( !ops.initialised ) { return NULL; }
-
-    return ops.chActiveCount;
-}
-
-/*
- * RADIO_getValidChCount
- *  -
- */
-uint8_t RADIO_getChValidCount ( void )
-{
-	if ( !ops.initialised ) { return 0; }
-
-    return ops.chValidCount;
-}
-
-/*
- * RADIO_inFaultState
- *   - True if there’s currently no valid radio input.
- */
-bool RADIO_inFaultStateCH ( RADIO_chIndex_t c )
-{
-	if ( !ops.initialised ) { return true; }
-
-	if ( ops.protocol == PWM ) {
-		return ops.getInputLost()[c];
-	} else {
-		return *ops.getInputLost();
-	}
-}
-
-/*
- * RADIO_inFaultStateALL
- *  -
- */
-bool RADIO_inFaultStateALL ( void )
-{
-	if ( !ops.initialised ) { return true; }
-
-	if ( ops.protocol == PWM ) {
-		for ( uint8_t i = 0; i < ops.chCount; i++ ) {
-			if ( !ops.getInputLost()[i] ) {
-				return false;
-			}
-		}
-		return true;
-	} else {
-		return *ops.getInputLost();
-	}
-}
-
-/*
- * RADIO_inFaultStateANY
- *  -
- */
-bool RADIO_inFaultStateANY ( void )
-{
-	if ( !ops.initialised ) { return true; }
-
-	if ( ops.protocol == PWM ) {
-		for ( uint8_t i = 0; i < ops.chCount; i++ ) {
-			if ( ops.getInputLost()[i] ) {
-				return true;
-			}
-		}
-		return false;
-	} else {
-		return *ops.getInputLost();
-	}
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE FUNCTIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-static inline bool RADIO_tryProtocol ( RADIO_protocol_t p )
-{
-	ops.protocol = p;
-
-	switch (p) {
-	#ifdef RADIO_USE_PPM
-	case PPM:
-		ops.chCount			= PPM_CH_NUM;
-    	ops.getData 		= PPM_getData;
-    	ops.getInputLost	= PPM_getInputLost;
-		return PPM_Detect();
-	#endif
-	#ifdef RADIO_USE_IBUS
-	case IBUS;
-		ops.chCount			= IBUS_CH_NUM;
-    	ops.getData 		= IBUS_getData;
-    	ops.getInputLost 	= IBUS_getInputLost;
-		return IBUS_Detect();
-	#endif
-	#ifdef RADIO_USE_SBUS
-	case SBUS:
-		ops.chCount			= SBUS_CH_NUM;
-    	ops.getData 		= SBUS_getData;
-    	ops.getInputLost 	= SBUS_getInputLost;
-		return SBUS_Detect();
-	#endif
-	#ifdef RADIO_USE_CRSF
-	case CRSF:
-		ops.chCount			= CRSF_CH_NUM;
-    	ops.getData 		= CRSF_getData;
-    	ops.getInputLost 	= CRSF_getInputLost;
-		return CRSF_Detect();
-	#endif
-	case PWM:
-	default:
-		ops.chCount			= PWM_CH_NUM;
-    	ops.getData 		= PWM_getData;
-    	ops.getInputLost 	= PWM_getInputLost;
-		return PWM_Detect();
-	}
-}
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EVENT HANDLERS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* INTERRUPT ROUTINES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Radio.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#define RADIO_CANDIDATE_NUM		(sizeof(candidates) / sizeof(candidates[0]))
+
+#define RADIO_LASTGOOD_FRAMES	5		/* Validation window for the stored configuration, in frame periods */
+#define RADIO_LASTGOOD_CHECK	0xA5
+
+#define RADIO_SOURCE_NUM		2
+#define RADIO_SELECT_LQ_GAIN	2		/* Selection score per % link quality 						*/
+#define RADIO_SELECT_AGE_MAX	100		/* Frame age (ms) is subtracted from the score up to this	*/
+#define RADIO_SELECT_HYST		20		/* Score margin the standby input needs to take over		*/
+#define RADIO_SELECT_LOST		INT32_MIN
+
+/* Static RAM of this module, including the decoder work areas. Build with RADIO_RAM_BUDGET to check it */
+#ifdef RADIO_USE_MIXER
+#define RADIO_MIXER_RAM			(sizeof(mixer) + sizeof(mixerStale))
+#else
+#define RADIO_MIXER_RAM			0
+#endif
+#ifdef RADIO_USE_CALIBRATION
+#define RADIO_CALIB_RAM			sizeof(calib)
+#else
+#define RADIO_CALIB_RAM			0
+#endif
+#ifdef RADIO_USE_SMOOTHING
+#define RADIO_SMOOTH_RAM		(sizeof(smooth) + sizeof(smoothPeriod))
+#else
+#define RADIO_SMOOTH_RAM		0
+#endif
+#ifdef RADIO_USE_FILTER
+#define RADIO_FILTER_RAM		sizeof(filter)
+#else
+#define RADIO_FILTER_RAM		0
+#endif
+#if defined(RADIO_USE_CALIBRATION) || defined(RADIO_USE_FILTER)
+#define RADIO_PROCESSED_RAM		sizeof(processed)
+#else
+#define RADIO_PROCESSED_RAM		0
+#endif
+#ifdef RADIO_USE_FAILSAFE
+#define RADIO_FAILSAFE_RAM		sizeof(failsafe)
+#else
+#define RADIO_FAILSAFE_RAM		0
+#endif
+#define RADIO_RAM_SIZE			(sizeof(ops) + sizeof(detect) + sizeof(snapshot) + sizeof(snapshotSeq) \
+								+ sizeof(frameEvent) + sizeof(framePending) + RADIO_MIXER_RAM + RADIO_CALIB_RAM \
+								+ RADIO_SMOOTH_RAM + RADIO_FILTER_RAM + RADIO_PROCESSED_RAM + RADIO_FAILSAFE_RAM)
+
+#if defined(RADIO_USE_FAILSAFE) && RADIO_CH_NUM_MAX > FAILSAFE_CH_NUM
+#error "error: FAILSAFE_CH_NUM is less than the channels of a protocol built in"
+#endif
+
+/* Protocol calls. With a single protocol built in these resolve to direct calls at compile time */
+#if !defined(RADIO_NO_PWM) + defined(RADIO_USE_PPM) + defined(RADIO_USE_IBUS) + defined(RADIO_USE_SBUS) + defined(RADIO_USE_CRSF) == 1
+  #if defined(RADIO_USE_PPM)
+    #define RADIO_SINGLE(fn)		PPM_##fn
+    #define RADIO_SINGLE_CTX(s)		(&(s)->decoder.ppm)
+  #elif defined(RADIO_USE_IBUS)
+    #define RADIO_SINGLE(fn)		IBUS_##fn
+    #define RADIO_SINGLE_CTX(s)		(&(s)->decoder.ibus)
+  #elif defined(RADIO_USE_SBUS)
+    #define RADIO_SINGLE(fn)		SBUS_##fn
+    #define RADIO_SINGLE_CTX(s)		(&(s)->decoder.sbus)
+  #elif defined(RADIO_USE_CRSF)
+    #define RADIO_SINGLE(fn)		CRSF_##fn
+    #define RADIO_SINGLE_CTX(s)		(&(s)->decoder.crsf)
+  #else
+    #define RADIO_SINGLE(fn)		PWM_##fn
+    #define RADIO_SINGLE_CTX(s)		(&(s)->decoder.pwm)
+  #endif
+  #define RADIO_DETECT(s)			RADIO_SINGLE(Detect)( RADIO_SINGLE_CTX(s) )
+  #define RADIO_UPDATE(s)			RADIO_SINGLE(Update)( RADIO_SINGLE_CTX(s) )
+  #define RADIO_GET_DATA(s)			RADIO_SINGLE(getData)( RADIO_SINGLE_CTX(s) )
+  #define RADIO_GET_LOST(s)			RADIO_SINGLE(getInputLost)( RADIO_SINGLE_CTX(s) )
+  #define RADIO_GET_FRAMES(s)		RADIO_SINGLE(getFrameCount)( RADIO_SINGLE_CTX(s) )
+  #define RADIO_GET_TIME(s)			RADIO_SINGLE(getFrameTime)( RADIO_SINGLE_CTX(s) )
+  #define RADIO_GET_LQ(s)			RADIO_SINGLE(getLinkQuality)( RADIO_SINGLE_CTX(s) )
+#else
+  #define RADIO_DETECT(s)			(s)->ops->detect( &(s)->decoder )
+  #define RADIO_UPDATE(s)			(s)->ops->update( &(s)->decoder )
+  #define RADIO_GET_DATA(s)			(s)->ops->getData( &(s)->decoder )
+  #define RADIO_GET_LOST(s)			(s)->ops->getInputLost( &(s)->decoder )
+  #define RADIO_GET_FRAMES(s)		(s)->ops->getFrameCount( &(s)->decoder )
+  #define RADIO_GET_TIME(s)			(s)->ops->getFrameTime( &(s)->decoder )
+  #define RADIO_GET_LQ(s)			(s)->ops->getLinkQuality( &(s)->decoder )
+#endif
+
+/* Active input and its protocol, as one byte for the modules that key on where the channels come from */
+#define RADIO_SOURCE_KEY(s)			((uint8_t)((ops.active << 4) | (s)->protocol))
+
+/* Channels the outputs are built from: the decoder's, or their filtered and calibrated copy */
+#if defined(RADIO_USE_CALIBRATION) || defined(RADIO_USE_FILTER)
+  #define RADIO_INPUT(s)			((void)(s), processed.ch)
+#else
+  #define RADIO_INPUT(s)			RADIO_GET_DATA( s )
+#endif
+
+/* The outputs: those channels, or the failsafe frame while any are lost */
+#ifdef RADIO_USE_FAILSAFE
+  #define RADIO_OUTPUT(s)			FAILSAFE_Output( &failsafe, RADIO_INPUT( s ) )
+#else
+  #define RADIO_OUTPUT(s)			RADIO_INPUT( s )
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Work area of one input. Only one protocol runs on an input at a time, so every
+ * decoder (and the autobaud measurement) shares it rather than owning its buffers.
+ * It is claimed by the decoder's init and cleared again when the input stops.
+ */
+typedef union {
+#ifdef RADIO_USE_AUTOBAUD
+	AUTOBAUD_t			autobaud;		/* Primary only, before any protocol runs */
+#endif
+#ifndef RADIO_NO_PWM
+	PWM_t				pwm;
+#endif
+#ifdef RADIO_USE_PPM
+	PPM_t				ppm;
+#endif
+#ifdef RADIO_USE_IBUS
+	IBUS_t				ibus;
+#endif
+#ifdef RADIO_USE_SBUS
+	SBUS_t				sbus;
+#endif
+#ifdef RADIO_USE_CRSF
+	CRSF_t				crsf;
+#endif
+} RADIO_decoder_t;
+
+/* One running receiver input */
+typedef struct {
+	bool 				running;
+	RADIO_protocol_t 	protocol;
+	const RADIO_ops_t *	ops;
+	RADIO_decoder_t		decoder;		/* Passed to every ops call				*/
+    uint32_t			frameCount;		/* Protocol frame count last seen		*/
+    uint32_t			frameTick;		/* Tick that frame count was first seen	*/
+    bool 				fresh;			/* New frame seen this update			*/
+} RADIO_source_t;
+
+typedef struct {
+	bool 				initialised;
+	RADIO_source_t		source[RADIO_SOURCE_NUM];	/* Indexed by RADIO_input_t		*/
+	RADIO_input_t		active;						/* Input feeding the outputs	*/
+	bool 				updating;					/* Inside RADIO_Update			*/
+	uint32_t			frameSeq;					/* Frames taken from the inputs	*/
+	uint32_t			frameTime;					/* US_Read() at the last frame	*/
+	void 				( *onFrame )( RADIO_input_t );
+    RADIO_chActive_t	chActiveCount[RADIO_CH_NUM_MAX];
+    uint8_t 			chValidCount;
+	uint16_t			chLast[RADIO_CH_NUM_MAX];	/* Outputs as last compared		*/
+	RADIO_chMask_t		chLastLost;					/* Lost channels as last compared */
+	uint8_t				chLastCount;				/* 0 to compare every channel	*/
+	uint32_t			chChangedSeq;				/* Frame chChanged belongs to	*/
+	RADIO_chMask_t		chChanged;					/* Moved since the last frame	*/
+#ifdef RADIO_LAZY_DECODE
+	RADIO_chMask_t		unsubscribed;				/* Channels the decoders skip	*/
+#endif
+} RADIO_ops;
+
+#if defined(RADIO_USE_CALIBRATION) || defined(RADIO_USE_FILTER)
+/* Filtered and calibrated copy of the active input's channels, made in place */
+typedef struct {
+	uint8_t				chCount;	/* 0 until made, or to remake every channel	*/
+	uint16_t			ch[RADIO_CH_NUM_MAX];
+} RADIO_chCopy_t;
+#endif
+
+/* One protocol configuration to listen for during detection */
+typedef struct {
+	RADIO_protocol_t	protocol;
+	uint32_t			baud;		/* 0 for non-serial protocols	*/
+	bool 				inverted;	/* Serial line idles low		*/
+	uint32_t			periodMs;	/* Nominal frame period			*/
+	uint32_t			windowMs;
+} RADIO_candidate_t;
+
+typedef enum {
+	RADIO_Pass_LastGood,	/* Stored configuration from the previous lock			*/
+	RADIO_Pass_Measured,	/* Single candidate configured from the autobaud result	*/
+	RADIO_Pass_Initial,		/* Table candidates for 'initial'						*/
+	RADIO_Pass_Others,		/* Every other table candidate							*/
+} RADIO_pass_t;
+
+/* Background detection progress */
+typedef struct {
+	RADIO_detectState_t	state;
+	RADIO_protocol_t	initial;
+	uint8_t				pass;		/* RADIO_pass_t							*/
+	uint8_t				index;		/* Table candidate under test			*/
+	RADIO_candidate_t	current;	/* Configuration currently running		*/
+	uint32_t			start;		/* Tick the current candidate started	*/
+	void 				( *onLock )( RADIO_protocol_t );
+	const RADIO_storage_t * storage;
+	RADIO_lastGood_t	lastGood;	/* As loaded from storage				*/
+} RADIO_detect_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static bool RADIO_startProtocol		( RADIO_source_t *, const RADIO_candidate_t * );
+static void RADIO_stopProtocol		( RADIO_source_t * );
+static void RADIO_updateProtocol	( RADIO_source_t * );
+static bool RADIO_detectProtocol	( RADIO_source_t * );
+
+static RADIO_source_t *	RADIO_activeSource	( void );
+static bool 			RADIO_sourceLost	( RADIO_source_t * );
+static void 			RADIO_selectSource	( void );
+static void 			RADIO_updateOutputs	( RADIO_source_t *, bool );
+#if defined(RADIO_USE_CALIBRATION) || defined(RADIO_USE_FILTER)
+static RADIO_chMask_t	RADIO_sampled		( RADIO_source_t *, bool );
+#endif
+static void 			RADIO_publish		( RADIO_source_t *, bool );
+
+static void 			RADIO_frameEvent	( RADIO_input_t );
+static void 			RADIO_primaryFrame	( void );
+static void 			RADIO_secondaryFrame( void );
+static bool 			RADIO_isSecondary	( RADIO_protocol_t );
+static const RADIO_candidate_t * RADIO_defaultCandidate ( RADIO_protocol_t );
+
+static void RADIO_stop				( void );
+static bool RADIO_detectStart		( const RADIO_candidate_t * );
+static void RADIO_detectBegin		( void );
+static void RADIO_detectSearch		( void );
+static void RADIO_detectNext		( void );
+static void RADIO_detectLock		( void );
+#ifdef RADIO_USE_AUTOBAUD
+static bool RADIO_detectMeasured	( void );
+#endif
+
+static bool 	RADIO_lastGoodLoad	( void );
+static void 	RADIO_lastGoodSave	( void );
+static uint8_t	RADIO_lastGoodCheck	( const RADIO_lastGood_t * );
+#ifdef RADIO_USE_CALIBRATION
+static void 	RADIO_calibrationLoad	( void );
+#endif
+#ifdef RADIO_USE_SMOOTHING
+static bool 	RADIO_smoothEvent		( RADIO_source_t *, bool, uint32_t * );
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static RADIO_ops ops;
+static RADIO_source_t * const primary	= &ops.source[RADIO_Input_Primary];
+static RADIO_source_t * const secondary	= &ops.source[RADIO_Input_Secondary];
+static RADIO_detect_t detect = { .state = RADIO_Detect_Idle };
+
+/*
+ * Published outputs. Two copies and a sequence whose low bit picks the one
+ * readers use, so a reader always has a copy that is not being written and
+ * never waits on the writer, even if it preempts it.
+ */
+static volatile RADIO_snapshot_t snapshot[2];
+
+/* Set by the decoders' frame callbacks, possibly from interrupts. Events coalesce */
+static volatile bool frameEvent[RADIO_SOURCE_NUM];
+static volatile bool framePending[RADIO_SOURCE_NUM];
+static uint32_t snapshotSeq = 0;
+
+#ifdef RADIO_USE_MIXER
+static MIXER_t mixer;		/* Empty until RADIO_setMixer() */
+static bool mixerStale;		/* Table changed since the outputs were mixed */
+#endif
+
+#ifdef RADIO_USE_CALIBRATION
+static CALIB_t calib;
+#endif
+
+#ifdef RADIO_USE_SMOOTHING
+static SMOOTH_t smooth;
+static uint32_t smoothPeriod;	/* PWM period count the ramps last took */
+#endif
+
+#ifdef RADIO_USE_FILTER
+static FILTER_t filter;		/* Every channel passes until RADIO_setFilter() */
+#endif
+
+#if defined(RADIO_USE_CALIBRATION) || defined(RADIO_USE_FILTER)
+static RADIO_chCopy_t processed;
+#endif
+
+#ifdef RADIO_USE_FAILSAFE
+static FAILSAFE_t failsafe;	/* Lost channels pass until RADIO_setFailsafe() */
+#endif
+
+#ifdef RADIO_RAM_BUDGET
+_Static_assert( RADIO_RAM_SIZE <= RADIO_RAM_BUDGET, "error: radio state is larger than RADIO_RAM_BUDGET" );
+#endif
+
+/* Indexed by RADIO_protocol_t */
+static const RADIO_ops_t * const protocolOps[RADIO_NUM_PROTOCOL] = {
+#ifndef RADIO_NO_PWM
+	[PWM]	= &PWM_ops,
+#endif
+#ifdef RADIO_USE_PPM
+	[PPM]	= &PPM_ops,
+#endif
+#ifdef RADIO_USE_IBUS
+	[IBUS]	= &IBUS_ops,
+#endif
+#ifdef RADIO_USE_SBUS
+	[SBUS]	= &SBUS_ops,
+#endif
+#ifdef RADIO_USE_CRSF
+	[CRSF]	= &CRSF_ops,
+#endif
+};
+
+/* Detection order within a pass. The first entry of each protocol is its default configuration */
+static const RADIO_candidate_t candidates[] = {
+#ifndef RADIO_NO_PWM
+	{ PWM,	0,				false,	PWM_PERIOD_MS,			PWM_DETECT_MS	},
+#endif
+#ifdef RADIO_USE_PPM
+	{ PPM,	0,				false,	PPM_PERIOD,				PPM_DETECT_MS	},
+#endif
+#ifdef RADIO_USE_IBUS
+	{ IBUS,	IBUS_BAUD,		false,	IBUS_PERIOD,			IBUS_DETECT_MS	},
+#endif
+#ifdef RADIO_USE_SBUS
+	{ SBUS,	SBUS_BAUD,		true,	SBUS_PERIOD_ANALOGUE,	SBUS_DETECT_MS	},
+	{ SBUS,	SBUS_BAUD_FAST,	true,	SBUS_PERIOD_FAST,		SBUS_DETECT_MS	},
+#endif
+#ifdef RADIO_USE_CRSF
+	{ CRSF,	CRSF_BAUD,		false,	CRSF_PERIOD_MS,			CRSF_DETECT_MS	},
+#endif
+};
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * RADIO_setStorage
+ *  - Optional. Call before RADIO_Init() to persist the locked configuration.
+ *  - On the next RADIO_Init() the stored configuration is tried first, with a
+ *    validation window of RADIO_LASTGOOD_FRAMES frame periods.
+ */
+void RADIO_setStorage ( const RADIO_storage_t * storage )
+{
+	detect.storage = storage;
+}
+
+/*
+ * RADIO_Init
+ *  - Non-blocking. Starts listening for the 'initial' protocol and returns immediately.
+ *  - Detection advances inside RADIO_Update(). If no valid input appears, every other
+ *    enabled protocol is tried in turn, then 'initial' is run until input arrives.
+ *  - With RADIO_USE_AUTOBAUD, the RX pin is first measured for baud rate and idle
+ *    polarity and the matching serial protocol is tried once at that configuration.
+ *  - With RADIO_setStorage(), the last locked configuration is tried before anything else.
+ *  - Use RADIO_getDetectState() or RADIO_OnLock() to find out when a protocol is locked.
+ *  - Returns the protocol currently being listened for.
+ */
+RADIO_protocol_t RADIO_Init ( RADIO_protocol_t initial )
+{
+	if ( ops.initialised ) {
+		RADIO_stop();
+	}
+
+	ops.initialised = true;
+	ops.active		= RADIO_Input_Primary;
+
+	detect.initial	= initial < RADIO_NUM_PROTOCOL ? initial : candidates[0].protocol;
+
+	// The primary input takes priority over a secondary on the same protocol
+	if ( RADIO_isSecondary(detect.initial) ) {
+		RADIO_DeinitSecondary();
+	}
+
+#ifdef RADIO_USE_CALIBRATION
+	RADIO_calibrationLoad();
+#endif
+
+	if ( !RADIO_lastGoodLoad() ) {
+		RADIO_detectBegin();
+	}
+
+	return primary->protocol;
+}
+
+/*
+ * RADIO_InitSecondary
+ *  - Optional. Call after RADIO_Init() to run a second receiver alongside the primary
+ *    (e.g CRSF on one UART, SBUS or PWM on another). It must be a different protocol,
+ *    and primary detection no longer considers it.
+ *  - Both inputs are decoded every RADIO_Update(). The outputs follow the valid input
+ *    with the best link quality and freshest frame, see RADIO_getActiveInput().
+ *  - Returns false if not initialised, the protocol is already used by the primary,
+ *    or its decoder could not start (e.g PPM_INSTANCE_NUM receivers already running).
+ */
+bool RADIO_InitSecondary ( RADIO_protocol_t protocol )
+{
+	if ( !ops.initialised || protocol >= RADIO_NUM_PROTOCOL ) { return false; }
+	if ( protocol == detect.initial || (primary->running && primary->protocol == protocol) ) {
+		return false;
+	}
+
+	RADIO_DeinitSecondary();
+	return RADIO_startProtocol( secondary, RADIO_defaultCandidate(protocol) );
+}
+
+/*
+ * RADIO_Deinit
+ *  -
+ */
+void RADIO_Deinit ( void )
+{
+	if ( !ops.initialised ) { return; }
+
+	RADIO_stop();
+	RADIO_DeinitSecondary();
+
+	ops.initialised = false;
+	detect.state = RADIO_Detect_Idle;
+}
+
+/*
+ * RADIO_DeinitSecondary
+ *  -
+ */
+void RADIO_DeinitSecondary ( void )
+{
+	if ( !secondary->running ) { return; }
+
+	RADIO_stopProtocol( secondary );
+	ops.active = RADIO_Input_Primary;
+}
+
+/*
+ * RADIO_Update
+ *  - Poll this in your main loop (every ~1ms) to refresh channel data & fault flags.
+ *  - Also advances protocol detection started by RADIO_Init().
+ */
+void RADIO_Update ( void )
+{
+	if ( !ops.initialised ) { return; }
+
+	ops.updating = true;
+
+#ifdef RADIO_USE_AUTOBAUD
+	if ( detect.state == RADIO_Detect_Autobaud ) {
+		if ( AUTOBAUD_Update( &primary->decoder.autobaud ) ) {
+			AUTOBAUD_Stop( &primary->decoder.autobaud );
+			detect.state = RADIO_Detect_Searching;
+			if ( !RADIO_detectMeasured() ) {
+				detect.pass  = RADIO_Pass_Initial;
+				detect.index = 0;
+				RADIO_detectSearch();
+			}
+		}
+	}
+#endif
+
+	RADIO_updateProtocol( primary );
+	RADIO_updateProtocol( secondary );
+
+	// Advance Background Detection
+	switch ( detect.state ) {
+	case RADIO_Detect_Searching:
+		if ( RADIO_detectProtocol(primary) ) {
+			RADIO_detectLock();
+		} else if ( (CORE_GetTick() - detect.start) >= detect.current.windowMs ) {
+			RADIO_detectNext();
+		}
+		break;
+	case RADIO_Detect_Fallback:
+		if ( RADIO_detectProtocol(primary) ) {
+			RADIO_detectLock();
+		} else if ( !primary->running && (CORE_GetTick() - detect.start) >= detect.current.windowMs ) {
+			// 'initial' could not start, try again each window
+			RADIO_detectStart( &detect.current );
+		}
+		break;
+	default:
+		break;
+	}
+
+	RADIO_input_t previous = ops.active;
+	RADIO_selectSource();
+
+	RADIO_source_t * s = RADIO_activeSource();
+
+	// A new frame on the active input, or a switch to the other, is a new frame out
+	bool newFrame = s != NULL && (s->fresh || ops.active != previous);
+	if ( newFrame ) {
+		ops.frameSeq++;
+		ops.frameTime = RADIO_GET_TIME( s );
+#ifdef RADIO_USE_FILTER
+		if ( ops.active != previous ) { FILTER_Reset( &filter ); }
+#endif
+	}
+
+	if ( s == NULL ) {
+		memset( ops.chActiveCount, chOFF, sizeof(ops.chActiveCount) );
+		ops.chValidCount = 0;
+		ops.chLastCount	 = 0;
+		RADIO_publish( NULL, false );
+	} else {
+		RADIO_updateOutputs( s, newFrame );
+	}
+
+#ifdef RADIO_USE_MIXER
+	// Identical inputs mix to identical outputs. Failsafe outputs move without frames
+	bool remix = newFrame;
+#ifdef RADIO_USE_FAILSAFE
+	remix |= s != NULL && FAILSAFE_getStage( &failsafe ) != FAILSAFE_Off;
+#endif
+	if ( remix && (ops.chChanged != 0 || mixerStale) ) {
+		// Lost channels hold their outputs, unless failsafe has a value for them
+		RADIO_chMask_t unmixed = RADIO_GET_LOST( s );
+#ifdef RADIO_USE_FAILSAFE
+		unmixed &= ~FAILSAFE_getSubstituted( &failsafe );
+#endif
+		MIXER_Apply( &mixer, RADIO_OUTPUT( s ), s->ops->chCount, unmixed );
+		mixerStale = false;
+	}
+#endif
+#ifdef RADIO_USE_SMOOTHING
+	uint32_t smoothTime;
+	if ( s != NULL && RADIO_smoothEvent( s, newFrame, &smoothTime ) ) {
+		SMOOTH_Frame( &smooth, RADIO_OUTPUT( s ), s->ops->chCount, smoothTime, RADIO_SOURCE_KEY( s ) );
+	}
+#endif
+
+	ops.updating = false;
+
+	// Frames committed during this update are reported now the outputs include them
+	for ( uint8_t i = 0; i < RADIO_SOURCE_NUM; i++ ) {
+		if ( framePending[i] ) {
+			framePending[i] = false;
+			if ( ops.onFrame != NULL ) { ops.onFrame( (RADIO_input_t)i ); }
+		}
+	}
+}
+
+/*
+ * RADIO_getProtocol
+ *  - Protocol on the primary input (under test while detection is still searching).
+ */
+RADIO_protocol_t RADIO_getProtocol ( void )
+{
+	return primary->protocol;
+}
+
+/*
+ * RADIO_getDetectState
+ *  -
+ */
+RADIO_detectState_t RADIO_getDetectState ( void )
+{
+	return detect.state;
+}
+
+/*
+ * RADIO_OnLock
+ *  - Registers a callback fired from RADIO_Update() once detection locks a protocol.
+ *  - Pass NULL to remove.
+ */
+void RADIO_OnLock ( void (*callback)(RADIO_protocol_t) )
+{
+	detect.onLock = callback;
+}
+
+/*
+ * RADIO_OnFrame
+ *  - Registers a callback fired as soon as either input's decoder commits a valid frame,
+ *    so a control loop can run straight away instead of on the next poll.
+ *  - PPM and PWM commit from their interrupts and the callback runs there; call
+ *    RADIO_Update() from it or wake a task that does. Serial frames are committed
+ *    inside RADIO_Update() and reported at the end of it, once the outputs are updated.
+ *    With RADIO_PARSE_IN_IRQ serial frames commit from RADIO_RX_IRQ() like PPM.
+ *  - Pass NULL to remove.
+ */
+void RADIO_OnFrame ( void (*callback)(RADIO_input_t) )
+{
+	ops.onFrame = callback;
+}
+
+/*
+ * RADIO_getFrameEvent
+ *  - True if any input has committed a frame since the last call. Clears the event.
+ *  - Alternative to RADIO_OnFrame() for loops that sleep until an interrupt.
+ */
+bool RADIO_getFrameEvent ( void )
+{
+	bool event = false;
+	for ( uint8_t i = 0; i < RADIO_SOURCE_NUM; i++ ) {
+		if ( frameEvent[i] ) {
+			frameEvent[i] = false;
+			event = true;
+		}
+	}
+	return event;
+}
+
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+/*
+ * RADIO_RX_IRQ
+ *  - Call from the UART receive interrupt of the input with each byte received.
+ *  - RADIO_RX_IN_IRQ queues it in the decoder's ring for RADIO_Update(), instead of
+ *    the decoder draining the UART driver's buffer.
+ *  - RADIO_PARSE_IN_IRQ parses it there and publishes complete frames, leaving
+ *    RADIO_Update() only the timeouts and outputs.
+ *  - Bytes are dropped while the input runs PPM or PWM, or nothing.
+ */
+void RADIO_RX_IRQ ( RADIO_input_t input, uint8_t byte )
+{
+	if ( input >= RADIO_SOURCE_NUM ) { return; }
+
+	RADIO_source_t * s = &ops.source[input];
+	if ( s->running && s->ops->rxByte != NULL ) {
+		s->ops->rxByte( &s->decoder, byte );
+	}
+}
+#endif
+
+/*
+ * RADIO_getActiveInput
+ *  - Input currently feeding RADIO_getData() and the fault flags.
+ */
+RADIO_input_t RADIO_getActiveInput ( void )
+{
+	return ops.active;
+}
+
+/*
+ * RADIO_getLinkQuality
+ *  - Link quality (%) of the active input. 0 if no input.
+ */
+uint8_t RADIO_getLinkQuality ( void )
+{
+	RADIO_source_t * s = RADIO_activeSource();
+	if ( !ops.initialised || s == NULL ) { return 0; }
+
+	return RADIO_GET_LQ( s );
+}
+
+/*
+ * RADIO_getSnapshot
+ *  - Copies the latest published frame. Safe from any task, thread or core,
+ *    alongside RADIO_Update() and other readers. Never blocks the writer.
+ *  - A snapshot is published for every new frame, and when the fault flags or
+ *    active input change between frames.
+ *  - Returns false until the first snapshot is published.
+ */
+bool RADIO_getSnapshot ( RADIO_snapshot_t * out )
+{
+	uint32_t seq;
+	do {
+		seq = __atomic_load_n( &snapshotSeq, __ATOMIC_ACQUIRE );
+		*out = snapshot[seq & 1];
+		__atomic_thread_fence( __ATOMIC_ACQUIRE );
+	} while ( seq != __atomic_load_n( &snapshotSeq, __ATOMIC_RELAXED ) );
+
+	return out->seq != 0;
+}
+
+/*
+ * RADIO_getSnapshotSeq
+ *  - Sequence of the latest snapshot. Cheap check for a new one before copying.
+ */
+uint32_t RADIO_getSnapshotSeq ( void )
+{
+	return __atomic_load_n( &snapshotSeq, __ATOMIC_ACQUIRE ) >> 1;
+}
+
+/*
+ * RADIO_getDataPtr
+ *  - After RADIO_Update(), use this to read ch[], inputLost, etc.
+ */
+uint16_t* RADIO_getData ( void )
+{
+	RADIO_source_t * s = RADIO_activeSource();
+	if ( !ops.initialised || s == NULL ) { return NULL; }
+
+	return RADIO_OUTPUT( s );
+}
+
+#ifdef RADIO_USE_HIRES
+/*
+ * RADIO_getNormalised
+ *  - Channels of the active input as Q15 (+-RADIO_Q15_ONE for RADIO_CH_MIN/MAX), keeping
+ *    the full resolution of the protocol (e.g 11 bit CRSF/SBUS). 0 where there is no data.
+ *  - Straight from the decoder: the filter and calibration apply to RADIO_getData() only.
+ */
+int16_t* RADIO_getNormalised ( void )
+{
+	RADIO_source_t * s = RADIO_activeSource();
+	if ( !ops.initialised || s == NULL ) { return NULL; }
+
+	return s->ops->getNormalised( &s->decoder );
+}
+
+/*
+ * RADIO_getRaw
+ *  - Channel values of the active input as the protocol sent them, before bounding and scaling.
+ */
+uint16_t* RADIO_getRaw ( void )
+{
+	RADIO_source_t * s = RADIO_activeSource();
+	if ( !ops.initialised || s == NULL ) { return NULL; }
+
+	return s->ops->getRaw( &s->decoder );
+}
+#endif
+
+/*
+ * RADIO_getInputLost
+ *  - Channels of the active input without valid data, CH1 in bit 0. All set if no input.
+ */
+RADIO_chMask_t RADIO_getInputLost ( void )
+{
+	RADIO_source_t * s = RADIO_activeSource();
+	if ( !ops.initialised || s == NULL ) { return RADIO_CH_MASK(RADIO_CH_NUM_MAX); }
+
+	return RADIO_GET_LOST( s );
+}
+
+/*
+ * RADIO_getFrameSeq
+ *  - Incremented each time the outputs take a new frame, from either input.
+ *    Unchanged between frames, so repeated or stale data can be recognised.
+ */
+uint32_t RADIO_getFrameSeq ( void )
+{
+	return ops.frameSeq;
+}
+
+/*
+ * RADIO_getFrameTime
+ *  - US_Read() timestamp of the last byte or edge of the frame in the outputs.
+ *    Serial frames parsed in RADIO_Update() are stamped when parsed.
+ */
+uint32_t RADIO_getFrameTime ( void )
+{
+	return ops.frameTime;
+}
+
+/*
+ * RADIO_getDataAge
+ *  - Microseconds since the frame in the outputs arrived. UINT32_MAX before the first frame.
+ */
+uint32_t RADIO_getDataAge ( void )
+{
+	if ( ops.frameSeq == 0 ) { return UINT32_MAX; }
+
+	return US_Read() - ops.frameTime;
+}
+
+/*
+ * RADIO_getChCount
+ *  -
+ */
+uint8_t RADIO_getChCount ( void )
+{
+	RADIO_source_t * s = RADIO_activeSource();
+	if ( !ops.initialised || s == NULL ) { return 0; }
+
+    return s->ops->chCount;
+}
+
+/*
+ * RADIO_getPtrChActive =
+ */
+RADIO_chActive_t* RADIO_getChActiveCount ( void )
+{
+	if ( !ops.initialised ) { return NULL; }
+
+    return ops.chActiveCount;
+}
+
+/*
+ * RADIO_getChChanged
+ *  - Channels whose output value or fault state changed with the last frame out,
+ *    compared to the frame before. All set when the channel count changes.
+ *  - Lets mixing, logging and telemetry skip channels that did not move.
+ */
+RADIO_chMask_t RADIO_getChChanged ( void )
+{
+	return ops.chChanged;
+}
+
+/*
+ * RADIO_isFrameIdentical
+ *  - True if the last frame out repeated the one before: same values, same faults.
+ */
+bool RADIO_isFrameIdentical ( void )
+{
+	return ops.frameSeq != 0 && ops.chChanged == 0;
+}
+
+/*
+ * RADIO_getValidChCount
+ *  -
+ */
+uint8_t RADIO_getChValidCount ( void )
+{
+	if ( !ops.initialised ) { return 0; }
+
+    return ops.chValidCount;
+}
+
+/*
+ * RADIO_inFaultState
+ *   - True if there’s currently no valid radio input.
+ */
+bool RADIO_inFaultStateCH ( RADIO_chIndex_t c )
+{
+	RADIO_source_t * s = RADIO_activeSource();
+	if ( !ops.initialised || s == NULL || c >= s->ops->chCount ) { return true; }
+
+	return ( RADIO_GET_LOST( s ) >> c ) & 1;
+}
+
+/*
+ * RADIO_inFaultStateALL
+ *  -
+ */
+bool RADIO_inFaultStateALL ( void )
+{
+	RADIO_source_t * s = RADIO_activeSource();
+	if ( !ops.initialised || s == NULL ) { return true; }
+
+	return RADIO_sourceLost( s );
+}
+
+/*
+ * RADIO_inFaultStateANY
+ *  -
+ */
+bool RADIO_inFaultStateANY ( void )
+{
+	RADIO_source_t * s = RADIO_activeSource();
+	if ( !ops.initialised || s == NULL ) { return true; }
+
+	return RADIO_GET_LOST( s ) != 0;
+}
+
+#ifdef RADIO_USE_MIXER
+/*
+ * RADIO_setMixer
+ *  - Compiles the output table, see MIXER_channel_t. Outputs update once per new frame.
+ *    Outputs of a lost input hold, unless failsafe gives it a value.
+ *  - Call from the context that runs RADIO_Update().
+ */
+void RADIO_setMixer ( const MIXER_channel_t * table, uint8_t count )
+{
+	MIXER_Init( &mixer, table, count );
+	mixerStale = true;
+}
+
+/*
+ * RADIO_getMixed
+ *  - Mixer outputs (Q15) in table order, from the last new frame.
+ */
+int16_t* RADIO_getMixed ( void )
+{
+	return MIXER_getOutput( &mixer );
+}
+
+/*
+ * RADIO_getMixedCount
+ *  -
+ */
+uint8_t RADIO_getMixedCount ( void )
+{
+	return MIXER_getCount( &mixer );
+}
+#endif
+
+#ifdef RADIO_LAZY_DECODE
+/*
+ * RADIO_Subscribe
+ *  - Channels the application reads, bit per channel. Decoders that unpack channels on
+ *    demand (CRSF, SBUS) skip the others, which keep their last value. All by default.
+ *  - Applies to both inputs and survives protocol changes.
+ */
+void RADIO_Subscribe ( RADIO_chMask_t mask )
+{
+	ops.unsubscribed = ~mask;
+
+	for ( uint8_t i = 0; i < RADIO_SOURCE_NUM; i++ ) {
+		RADIO_source_t * s = &ops.source[i];
+		if ( s->running && s->ops->subscribe != NULL ) {
+			s->ops->subscribe( &s->decoder, mask );
+		}
+	}
+}
+#endif
+
+#ifdef RADIO_USE_FILTER
+/*
+ * RADIO_setFilter
+ *  - Glitch filter settings per channel, in channel order, see FILTER_mode_t.
+ *    Each channel is filtered once per new sample, before calibration and everything else.
+ *  - Call from the context that runs RADIO_Update().
+ */
+void RADIO_setFilter ( const FILTER_channel_t * table, uint8_t count )
+{
+	FILTER_Init( &filter, table, count );
+}
+#endif
+
+#ifdef RADIO_USE_FAILSAFE
+/*
+ * RADIO_setFailsafe
+ *  - Policy per channel for when it is lost, in channel order, see FAILSAFE_mode_t.
+ *    Lost channels hold their last value for stageMs first, if not 0.
+ *  - The outputs carry the failsafe values while the fault flags still report the loss.
+ *  - Call from the context that runs RADIO_Update().
+ */
+void RADIO_setFailsafe ( const FAILSAFE_channel_t * table, uint8_t count, uint32_t stageMs )
+{
+	FAILSAFE_Init( &failsafe, table, count, stageMs );
+}
+
+/*
+ * RADIO_getFailsafe
+ *  -
+ */
+FAILSAFE_stage_t RADIO_getFailsafe ( void )
+{
+	return (FAILSAFE_stage_t)FAILSAFE_getStage( &failsafe );
+}
+#endif
+
+#ifdef RADIO_USE_SMOOTHING
+/*
+ * RADIO_getSmoothed
+ *  - Channels ramped from frame to frame over the measured frame interval, for
+ *    control loops running faster than the link. Lags RADIO_getData() by about a frame.
+ *    PWM ramps once per period, rather than per channel pulse.
+ *  - In failsafe, the failsafe outputs as they are.
+ *  - Call from the context that runs RADIO_Update().
+ */
+uint16_t* RADIO_getSmoothed ( void )
+{
+#ifdef RADIO_USE_FAILSAFE
+	if ( FAILSAFE_getStage( &failsafe ) == FAILSAFE_Active ) {
+		return RADIO_getData();
+	}
+#endif
+	return SMOOTH_Read( &smooth, US_Read() );
+}
+
+/*
+ * RADIO_getDerivative
+ *  - Rate of change of each smoothed channel in microseconds per second, for feed-forward.
+ */
+int32_t* RADIO_getDerivative ( void )
+{
+	return SMOOTH_getDerivative( &smooth );
+}
+
+/*
+ * RADIO_getFrameInterval
+ *  - Measured frame interval of the active input in microseconds, the period for PWM.
+ *    0 until measured.
+ */
+uint32_t RADIO_getFrameInterval ( void )
+{
+	return SMOOTH_getInterval( &smooth );
+}
+#endif
+
+#ifdef RADIO_USE_CALIBRATION
+/*
+ * RADIO_calibrateStart
+ *  - Learns each channel's endpoints and centre from live input. Move every stick and
+ *    switch through its full travel, release the sticks, then call RADIO_calibrateFinish().
+ *  - The outputs keep the previous calibration meanwhile. A switch to the other input,
+ *    or to another protocol, starts the learning over on it.
+ *  - The calibration only applies to the input and protocol it was learned on.
+ */
+void RADIO_calibrateStart ( void )
+{
+	CALIB_Start( &calib );
+}
+
+/*
+ * RADIO_calibrateFinish
+ *  - Applies what was learned and saves it through RADIO_setStorage(), if set.
+ *    Channels that were not moved pass through uncalibrated.
+ *  - Returns false if not calibrating or the save failed.
+ */
+bool RADIO_calibrateFinish ( void )
+{
+	CALIB_record_t rec;
+	if ( !CALIB_Finish( &calib, &rec ) ) { return false; }
+	processed.chCount = 0;
+
+	if ( detect.storage == NULL || detect.storage->saveCal == NULL ) { return true; }
+	return detect.storage->saveCal( &rec );
+}
+
+/*
+ * RADIO_isCalibrating
+ *  -
+ */
+bool RADIO_isCalibrating ( void )
+{
+	return CALIB_isLearning( &calib );
+}
+#endif
+
+/*
+ * RADIO_getRamSize
+ *  - Bytes of static RAM used by the radio state for this build, decoder work areas included.
+ */
+uint32_t RADIO_getRamSize ( void )
+{
+	return RADIO_RAM_SIZE;
+}
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * RADIO_startProtocol
+ *  - Binds the input to the candidate protocol and initialises it.
+ *  - Returns false, leaving the input stopped, if the decoder could not start.
+ */
+static bool RADIO_startProtocol ( RADIO_source_t * s, const RADIO_candidate_t * c )
+{
+	s->protocol		= c->protocol;
+	s->ops			= protocolOps[c->protocol];
+	s->frameTick	= CORE_GetTick();
+
+	if ( !s->ops->init( &s->decoder, c->baud, c->inverted ) ) {
+		memset( &s->decoder, 0, sizeof(s->decoder) );
+		return false;
+	}
+	s->running		= true;
+	s->ops->onFrame( &s->decoder, s == primary ? RADIO_primaryFrame : RADIO_secondaryFrame );
+#ifdef RADIO_LAZY_DECODE
+	if ( s->ops->subscribe != NULL ) {
+		s->ops->subscribe( &s->decoder, ~ops.unsubscribed );
+	}
+#endif
+
+	s->frameCount	= RADIO_GET_FRAMES( s );
+	return true;
+}
+
+/*
+ * RADIO_stopProtocol
+ *  -
+ */
+static void RADIO_stopProtocol ( RADIO_source_t * s )
+{
+	if ( !s->running ) { return; }
+	s->running = false;
+
+	s->ops->onFrame( &s->decoder, NULL );
+	s->ops->deinit( &s->decoder );
+	memset( &s->decoder, 0, sizeof(s->decoder) );
+}
+
+/*
+ * RADIO_updateProtocol
+ *  -
+ */
+static void RADIO_updateProtocol ( RADIO_source_t * s )
+{
+	if ( !s->running ) { return; }
+
+	RADIO_UPDATE( s );
+}
+
+/*
+ * RADIO_detectProtocol
+ *  - True once the input is receiving valid input.
+ */
+static bool RADIO_detectProtocol ( RADIO_source_t * s )
+{
+	return s->running && RADIO_DETECT( s );
+}
+
+/*
+ * RADIO_activeSource
+ *  - NULL while the active input is not running (e.g during autobaud).
+ */
+static RADIO_source_t * RADIO_activeSource ( void )
+{
+	RADIO_source_t * s = &ops.source[ops.active];
+	return s->running ? s : NULL;
+}
+
+/*
+ * RADIO_sourceLost
+ *  - True if the input has no valid channels.
+ */
+static bool RADIO_sourceLost ( RADIO_source_t * s )
+{
+	return RADIO_GET_LOST( s ) == RADIO_CH_MASK( s->ops->chCount );
+}
+
+/*
+ * RADIO_selectSource
+ *  - Scores each valid input on link quality less the age of its last frame.
+ *  - The standby input takes over straight away if the active one is lost. Otherwise
+ *    it needs a lead of RADIO_SELECT_HYST, and only switches on the update that sees
+ *    its new frame, so the outputs move from one complete frame to another.
+ */
+static void RADIO_selectSource ( void )
+{
+	uint32_t now = CORE_GetTick();
+	int32_t score[RADIO_SOURCE_NUM];
+	bool fresh[RADIO_SOURCE_NUM];
+
+	for ( uint8_t i = 0; i < RADIO_SOURCE_NUM; i++ )
+	{
+		RADIO_source_t * s = &ops.source[i];
+		score[i] = RADIO_SELECT_LOST;
+		fresh[i] = false;
+		if ( !s->running ) { continue; }
+
+		uint32_t count = RADIO_GET_FRAMES( s );
+		if ( count != s->frameCount ) {
+			s->frameCount = count;
+			s->frameTick  = now;
+			fresh[i] = true;
+		}
+		s->fresh = fresh[i];
+
+		if ( RADIO_sourceLost(s) ) { continue; }
+
+		uint32_t age = RADIO_MIN( now - s->frameTick, RADIO_SELECT_AGE_MAX );
+		score[i] = (int32_t)RADIO_GET_LQ( s ) * RADIO_SELECT_LQ_GAIN - (int32_t)age;
+	}
+
+	RADIO_input_t standby = ops.active == RADIO_Input_Primary ? RADIO_Input_Secondary : RADIO_Input_Primary;
+	if ( score[standby] == RADIO_SELECT_LOST ) { return; }
+
+	if ( score[ops.active] == RADIO_SELECT_LOST
+	 || ( fresh[standby] && score[standby] > score[ops.active] + RADIO_SELECT_HYST ) ) {
+		ops.active = standby;
+	}
+}
+
+/*
+ * RADIO_updateOutputs
+ *  - Channel activity, valid count and snapshot from the active input. newFrame as in RADIO_Update().
+ */
+static void RADIO_updateOutputs ( RADIO_source_t * s, bool newFrame )
+{
+	// Resolve the buffers once, the loops below make no calls
+	const uint16_t * data	= RADIO_GET_DATA( s );
+	const RADIO_chMask_t lost	= RADIO_GET_LOST( s );
+	const uint8_t chCount	= s->ops->chCount;
+
+#if defined(RADIO_USE_CALIBRATION) || defined(RADIO_USE_FILTER)
+	// Into one copy, filtered then calibrated in place; the decoder's channels stay as
+	// received. Only channels with a new sample are redone, lost ones pass as they are
+	RADIO_chMask_t sampled = RADIO_sampled( s, newFrame );
+	if ( processed.chCount != chCount ) {
+		processed.chCount = chCount;
+		sampled = RADIO_CH_MASK( chCount );
+#ifdef RADIO_USE_FILTER
+		FILTER_Reset( &filter );
+#endif
+	}
+	sampled |= lost;
+
+#ifdef RADIO_USE_FILTER
+	FILTER_Apply( &filter, data, processed.ch, chCount, lost, sampled );
+	data = processed.ch;
+#endif
+#ifdef RADIO_USE_CALIBRATION
+	// Calibration belongs to the input and protocol it was learned on
+	if ( CALIB_isLearning(&calib) ) {
+		CALIB_Sample( &calib, RADIO_SOURCE_KEY( s ), data, chCount, lost | ~sampled );
+	}
+	CALIB_Apply( &calib, RADIO_SOURCE_KEY( s ), data, processed.ch, chCount, sampled );
+#endif
+	data = processed.ch;
+#else
+	(void)newFrame;
+#endif
+
+#ifdef RADIO_USE_FAILSAFE
+	// Lost channels are substituted from here on, the fault flags still tell
+	FAILSAFE_Apply( &failsafe, data, chCount, lost, CORE_GetTick() );
+	data = RADIO_OUTPUT( s );
+#endif
+
+	// Changes build up over the updates of one frame out and restart with the next
+	if ( ops.chChangedSeq != ops.frameSeq ) {
+		ops.chChangedSeq = ops.frameSeq;
+		ops.chChanged	 = 0;
+	}
+
+	// Compare with the last outputs and redo the activity of channels that moved or
+	// changed fault state, in one pass. Usually most channels have done neither.
+	RADIO_chMask_t redo = ( chCount != ops.chLastCount ) ? RADIO_CH_MASK(chCount) : ( lost ^ ops.chLastLost );
+    for ( uint8_t i = 0; i < chCount; i++ ) {
+		if ( data[i] != ops.chLast[i] ) {
+			ops.chLast[i] = data[i];
+			redo |= 1UL << i;
+		}
+		if ( !((redo >> i) & 1) ) { continue; }
+
+        // Update Active Channel Count
+        if ( (lost >> i) & 1 ) {
+            ops.chActiveCount[i] = chOFF;
+        } else if ( data[i] > RADIO_CH_CENTERMAX ) {
+            ops.chActiveCount[i] = chFWD;
+        } else if ( data[i] < RADIO_CH_CENTERMIN ) {
+            ops.chActiveCount[i] = chRVS;
+        } else {
+            ops.chActiveCount[i] = chOFF;
+        }
+    }
+	ops.chChanged	|= redo;
+	ops.chLastLost	 = lost;
+	ops.chLastCount	 = chCount;
+
+    // Update Valid Channel Count
+	ops.chValidCount = chCount - __builtin_popcount( lost );
+
+	RADIO_publish( s, redo != 0 );
+}
+
+#if defined(RADIO_USE_CALIBRATION) || defined(RADIO_USE_FILTER)
+/*
+ * RADIO_sampled
+ *  - Channels of the active input with a new sample this update. Every channel on a new
+ *    frame, except PWM, which pulses channel by channel and so is taken per channel.
+ *    A switch to this input is a new sample of every channel.
+ */
+static RADIO_chMask_t RADIO_sampled ( RADIO_source_t * s, bool newFrame )
+{
+	RADIO_chMask_t all = RADIO_CH_MASK( s->ops->chCount );
+#ifndef RADIO_NO_PWM
+	if ( s->protocol == PWM ) {
+		RADIO_chMask_t pulsed = PWM_getUpdated( &s->decoder.pwm );
+		return ( newFrame && !s->fresh ) ? all : pulsed;
+	}
+#endif
+	return newFrame ? all : 0;
+}
+#endif
+
+/*
+ * RADIO_publish
+ *  - Publishes the active input as a new snapshot when it has a new frame, its
+ *    outputs moved without one (e.g failsafe), or its fault flags or the active
+ *    input have changed. NULL if none is running.
+ *  - Writes the copy readers are not using, moves them onto it, then brings the
+ *    other copy up to date.
+ */
+static void RADIO_publish ( RADIO_source_t * s, bool moved )
+{
+	const volatile RADIO_snapshot_t * last = &snapshot[snapshotSeq & 1];
+
+	const uint16_t * data		= s != NULL ? RADIO_OUTPUT( s ) : NULL;
+	const RADIO_chMask_t lost	= s != NULL ? RADIO_GET_LOST( s ) : 0;
+	const uint8_t chCount		= s != NULL ? s->ops->chCount : 0;
+
+	bool changed = ( moved || last->seq == 0 || last->frameSeq != ops.frameSeq || last->input != ops.active || last->chCount != chCount );
+	if ( s == NULL ) {
+		changed |= !last->inputLost;
+	} else {
+		changed |= ( last->chLost != lost );
+	}
+	if ( !changed ) { return; }
+
+	RADIO_snapshot_t next = {
+		.seq		= last->seq + 1,
+		.frameSeq	= ops.frameSeq,
+		.frameTime	= ops.frameTime,
+		.input		= ops.active,
+		.chCount	= chCount,
+		.inputLost	= s == NULL || RADIO_sourceLost( s ),
+		.chLost		= lost,
+		.chChanged	= ops.chChanged,
+	};
+	for ( uint8_t i = 0; i < chCount; i++ ) {
+		next.ch[i]	= data[i];
+	}
+
+	// Single writer, so plain stores to the sequence. Fences order them against the copies.
+	uint32_t seq = snapshotSeq;
+	__atomic_store_n( &snapshotSeq, seq + 1, __ATOMIC_RELAXED );
+	__atomic_thread_fence( __ATOMIC_RELEASE );
+	snapshot[0] = next;
+	__atomic_thread_fence( __ATOMIC_RELEASE );
+	__atomic_store_n( &snapshotSeq, seq + 2, __ATOMIC_RELAXED );
+	__atomic_thread_fence( __ATOMIC_RELEASE );
+	snapshot[1] = next;
+}
+
+/*
+ * RADIO_frameEvent
+ *  - A decoder committed a frame. May be called from an interrupt.
+ */
+static void RADIO_frameEvent ( RADIO_input_t input )
+{
+	frameEvent[input] = true;
+
+	// Wait for the end of RADIO_Update so the outputs include the frame
+	if ( ops.updating ) {
+		framePending[input] = true;
+	} else if ( ops.onFrame != NULL ) {
+		ops.onFrame( input );
+	}
+}
+
+static void RADIO_primaryFrame ( void )
+{
+	RADIO_frameEvent( RADIO_Input_Primary );
+}
+
+static void RADIO_secondaryFrame ( void )
+{
+	RADIO_frameEvent( RADIO_Input_Secondary );
+}
+
+/*
+ * RADIO_isSecondary
+ *  - True if the protocol is taken by the secondary input.
+ */
+static bool RADIO_isSecondary ( RADIO_protocol_t protocol )
+{
+	return secondary->running && secondary->protocol == protocol;
+}
+
+/*
+ * RADIO_defaultCandidate
+ *  - First table entry for the protocol.
+ */
+static const RADIO_candidate_t * RADIO_defaultCandidate ( RADIO_protocol_t protocol )
+{
+	for ( uint8_t i = 0; i < RADIO_CANDIDATE_NUM; i++ ) {
+		if ( candidates[i].protocol == protocol ) {
+			return &candidates[i];
+		}
+	}
+	return &candidates[0];
+}
+
+/*
+ * RADIO_stop
+ *  - Stops whatever currently owns the primary input.
+ */
+static void RADIO_stop ( void )
+{
+#ifdef RADIO_USE_AUTOBAUD
+	if ( detect.state == RADIO_Detect_Autobaud ) {
+		AUTOBAUD_Stop( &primary->decoder.autobaud );
+		memset( &primary->decoder, 0, sizeof(primary->decoder) );
+		return;
+	}
+#endif
+	RADIO_stopProtocol( primary );
+}
+
+/*
+ * RADIO_detectStart
+ *  - Runs a candidate on the primary input and starts its detection window.
+ *  - Returns false if it could not start.
+ */
+static bool RADIO_detectStart ( const RADIO_candidate_t * c )
+{
+	detect.current	= *c;
+	detect.start	= CORE_GetTick();
+	return RADIO_startProtocol( primary, c );
+}
+
+/*
+ * RADIO_detectBegin
+ *  - Starts a full detection: autobaud measurement if enabled, else the table sweep.
+ */
+static void RADIO_detectBegin ( void )
+{
+#ifdef RADIO_USE_AUTOBAUD
+	// No protocol runs while the RX pin is being measured
+	primary->protocol	= detect.initial;
+	detect.state		= RADIO_Detect_Autobaud;
+	AUTOBAUD_Start( &primary->decoder.autobaud );
+#else
+	detect.state	= RADIO_Detect_Searching;
+	detect.pass		= RADIO_Pass_Initial;
+	detect.index	= 0;
+	RADIO_detectSearch();
+#endif
+}
+
+/*
+ * RADIO_detectSearch
+ *  - Starts the next table candidate from detect.pass / detect.index, or falls back
+ *    to the default configuration of 'initial' once every candidate has been tried.
+ */
+static void RADIO_detectSearch ( void )
+{
+	for ( ; detect.pass <= RADIO_Pass_Others; detect.pass++, detect.index = 0 )
+	{
+		for ( ; detect.index < RADIO_CANDIDATE_NUM; detect.index++ )
+		{
+			// Initial pass only tries 'initial', the following pass tries everything else
+			RADIO_protocol_t protocol = candidates[detect.index].protocol;
+			bool isInitial = ( protocol == detect.initial );
+			// A candidate that cannot start (e.g its timer is taken) is skipped
+			if ( isInitial == (detect.pass == RADIO_Pass_Initial) && !RADIO_isSecondary(protocol)
+			 && RADIO_detectStart( &candidates[detect.index] ) ) {
+				return;
+			}
+		}
+	}
+
+	// Nothing found - run 'initial' and lock as soon as it sees input
+	detect.state = RADIO_Detect_Fallback;
+	detect.index = 0;
+	while ( candidates[detect.index].protocol != detect.initial ) {
+		detect.index++;
+	}
+	RADIO_detectStart( &candidates[detect.index] );
+}
+
+/*
+ * RADIO_detectNext
+ *  - Current candidate timed out. Moves on to the next one.
+ */
+static void RADIO_detectNext ( void )
+{
+	RADIO_stopProtocol( primary );
+
+	if ( detect.pass == RADIO_Pass_LastGood ) {
+		RADIO_detectBegin();
+		return;
+	}
+
+	if ( detect.pass == RADIO_Pass_Measured ) {
+		detect.pass  = RADIO_Pass_Initial;
+		detect.index = 0;
+	} else {
+		detect.index++;
+	}
+
+	RADIO_detectSearch();
+}
+
+/*
+ * RADIO_detectLock
+ *  -
+ */
+static void RADIO_detectLock ( void )
+{
+	detect.state = RADIO_Detect_Locked;
+
+	RADIO_lastGoodSave();
+
+	if ( detect.onLock != NULL ) {
+		detect.onLock( primary->protocol );
+	}
+}
+
+#ifdef RADIO_USE_AUTOBAUD
+/*
+ * RADIO_detectMeasured
+ *  - Starts the serial protocol whose default configuration best matches the
+ *    autobaud result, at the measured baud rate and polarity.
+ *  - Returns false if the measurement is unusable or no protocol matches.
+ */
+static bool RADIO_detectMeasured ( void )
+{
+	AUTOBAUD_Result * r = AUTOBAUD_getResult( &primary->decoder.autobaud );
+	if ( !r->valid ) { return false; }
+
+	const RADIO_candidate_t * best = NULL;
+	uint32_t bestError = UINT32_MAX;
+
+	for ( uint8_t i = 0; i < RADIO_CANDIDATE_NUM; i++ )
+	{
+		const RADIO_candidate_t * c = &candidates[i];
+		if ( c->baud == 0 || c->inverted != r->inverted || RADIO_isSecondary(c->protocol) ) { continue; }
+
+		// Relative error in 1/1024ths so rates of different magnitude compare fairly
+		uint32_t diff  = c->baud > r->baud ? c->baud - r->baud : r->baud - c->baud;
+		uint32_t error = (uint32_t)(((uint64_t)diff << 10) / c->baud);
+		if ( error < bestError ) {
+			bestError = error;
+			best = c;
+		}
+	}
+	if ( best == NULL ) { return false; }
+
+	RADIO_candidate_t measured = *best;
+	measured.baud = r->baud;
+
+	detect.pass = RADIO_Pass_Measured;
+	return RADIO_detectStart( &measured );
+}
+#endif
+
+/*
+ * RADIO_lastGoodLoad
+ *  - Starts the stored configuration if storage is set and holds a valid record.
+ */
+static bool RADIO_lastGoodLoad ( void )
+{
+	memset( &detect.lastGood, 0, sizeof(detect.lastGood) );
+
+	if ( detect.storage == NULL || detect.storage->load == NULL ) { return false; }
+	if ( !detect.storage->load( &detect.lastGood ) ) { return false; }
+
+	RADIO_lastGood_t * lg = &detect.lastGood;
+	if ( lg->check != RADIO_lastGoodCheck(lg) || lg->protocol >= RADIO_NUM_PROTOCOL ) {
+		return false;
+	}
+	if ( RADIO_isSecondary(lg->protocol) ) { return false; }
+
+	// Reject records from a build with a different protocol/channel configuration
+	const RADIO_candidate_t * c = RADIO_defaultCandidate( lg->protocol );
+	if ( (c->baud == 0) != (lg->baud == 0) ) { return false; }
+
+	RADIO_candidate_t stored = {
+		.protocol	= lg->protocol,
+		.baud		= lg->baud,
+		.inverted	= lg->inverted,
+		.periodMs	= lg->periodMs,
+		.windowMs	= RADIO_MIN( lg->periodMs * RADIO_LASTGOOD_FRAMES, c->windowMs ),
+	};
+
+	detect.state = RADIO_Detect_Searching;
+	detect.pass  = RADIO_Pass_LastGood;
+	if ( !RADIO_detectStart( &stored ) ) { return false; }
+
+	if ( primary->ops->chCount != lg->chCount ) {
+		RADIO_stopProtocol( primary );
+		return false;
+	}
+	return true;
+}
+
+/*
+ * RADIO_lastGoodSave
+ *  - Persists the locked configuration. Skipped when unchanged to spare the flash.
+ */
+static void RADIO_lastGoodSave ( void )
+{
+	if ( detect.storage == NULL || detect.storage->save == NULL ) { return; }
+
+	RADIO_lastGood_t lg = {
+		.protocol	= detect.current.protocol,
+		.inverted	= detect.current.inverted,
+		.chCount	= primary->ops->chCount,
+		.baud		= detect.current.baud,
+		.periodMs	= detect.current.periodMs,
+	};
+	lg.check = RADIO_lastGoodCheck( &lg );
+
+	if ( memcmp(&lg, &detect.lastGood, sizeof(lg)) != 0 ) {
+		if ( detect.storage->save( &lg ) ) {
+			detect.lastGood = lg;
+		}
+	}
+}
+
+#ifdef RADIO_USE_CALIBRATION
+/*
+ * RADIO_calibrationLoad
+ *  - Compiles the stored calibration, if any. Every channel passes through otherwise.
+ */
+static void RADIO_calibrationLoad ( void )
+{
+	CALIB_Init( &calib );
+	processed.chCount = 0;
+
+	if ( detect.storage == NULL || detect.storage->loadCal == NULL ) { return; }
+
+	CALIB_record_t rec;
+	if ( detect.storage->loadCal( &rec ) ) {
+		CALIB_Load( &calib, &rec );
+	}
+}
+#endif
+
+/*
+ * RADIO_lastGoodCheck
+ *  -
+ */
+static uint8_t RADIO_lastGoodCheck ( const RADIO_lastGood_t * lg )
+{
+	uint8_t check = RADIO_LASTGOOD_CHECK;
+	check ^= lg->protocol;
+	check ^= lg->inverted;
+	check ^= lg->chCount;
+	for ( uint8_t b = 0; b < 32; b += 8 ) {
+		check ^= (uint8_t)(lg->baud >> b);
+		check ^= (uint8_t)(lg->periodMs >> b);
+	}
+	return check;
+}
+
+#ifdef RADIO_USE_SMOOTHING
+/*
+ * RADIO_smoothEvent
+ *  - True if the smoothing ramps take a new frame this update, with its timestamp.
+ *  - PWM channels pulse one after another across the period, and each pulse is a frame
+ *    out. Ramping on those would spread each channel over a fraction of its period, so
+ *    PWM ramps once per period on the CH1 pulse instead, for as long as CH1 has input.
+ */
+static bool RADIO_smoothEvent ( RADIO_source_t * s, bool newFrame, uint32_t * time )
+{
+	*time = ops.frameTime;
+#ifndef RADIO_NO_PWM
+	if ( s->protocol == PWM && !(RADIO_GET_LOST( s ) & (1UL << CH1)) ) {
+		uint32_t period	= PWM_getPeriodCount( &s->decoder.pwm );
+		// A switch to this input is a frame out without a pulse, and restarts the ramps
+		bool event		= ( period != smoothPeriod || (newFrame && !s->fresh) );
+		smoothPeriod	= period;
+		*time			= PWM_getPeriodTime( &s->decoder.pwm );
+		return event;
+	}
+#endif
+	return newFrame;
+}
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -1,124 +1,329 @@
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#ifndef RADIO_H
-#define RADIO_H
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#include "STM32X.h"
-
-#include "PWM.h"
-#ifdef RADIO_USE_PPM
-#include "PPM.h"
-#endif
-#ifdef RADIO_USE_IBUS
-#include "IBUS.h"
-#endif
-#ifdef RADIO_USE_SBUS
-#include "SBUS.h"
-#endif
-#ifdef RADIO_USE_CRSF
-#include "CRSF.h"
-#endif
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#define RADIO_MIN(X, Y)    	(((X) < (Y)) ? (X) : (Y))
-#define RADIO_MAX(X, Y)		(((X) > (Y)) ? (X) : (Y))
-
-#define RADIO_CH_NUM_BASE   PWM_CH_NUM
-#ifdef RADIO_USE_PPM
-  #define RADIO_CH_NUM_PPM  RADIO_MAX(PPM_CH_NUM, RADIO_CH_NUM_BASE)
-#else
-  #define RADIO_CH_NUM_PPM  RADIO_CH_NUM_BASE
-#endif
-#ifdef RADIO_USE_IBUS
-  #define RADIO_CH_NUM_IBUS RADIO_MAX(IBUS_CH_NUM, RADIO_CH_NUM_PPM)
-#else
-  #define RADIO_CH_NUM_IBUS RADIO_CH_NUM_PPM
-#endif
-#ifdef RADIO_USE_SBUS
-  #define RADIO_CH_NUM_SBUS RADIO_MAX(SBUS_CH_NUM, RADIO_CH_NUM_IBUS)
-#else
-  #define RADIO_CH_NUM_SBUS RADIO_CH_NUM_IBUS
-#endif
-#ifdef RADIO_USE_CRSF
-  #define RADIO_CH_NUM_MAX  RADIO_MAX(CRSF_CH_NUM, RADIO_CH_NUM_SBUS)
-#else
-  #define RADIO_CH_NUM_MAX  RADIO_CH_NUM_SBUS
-#endif
-
-#define RADIO_CH_MIN        1000
-#define RADIO_CH_MAX        2000
-#define RADIO_CH_CENTER     1500 //((RADIO_CH_MAX - RADIO_CH_MIN) / 2) //1500
-#define RADIO_CH_FULLSCALE 	1000 //(RADIO_CH_MAX - RADIO_CH_MIN)
-#define RADIO_CH_HALFSCALE	500 //(RADIO_CH_FULLSCALE / 2)
-
-#define RADIO_CH_STRETCH    300
-#define RADIO_CH_ERROR      50
-#define RADIO_CH_DEADBAND   50
-
-#define RADIO_CH_ABSMIN     (RADIO_CH_MIN    - RADIO_CH_STRETCH - RADIO_CH_ERROR)
-#define RADIO_CH_ABSMAX     (RADIO_CH_MAX    + RADIO_CH_STRETCH + RADIO_CH_ERROR)
-#define RADIO_CH_CENTERMIN  (RADIO_CH_CENTER - RADIO_CH_DEADBAND)
-#define RADIO_CH_CENTERMAX	(RADIO_CH_CENTER + RADIO_CH_DEADBAND)
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC TYPES      									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-typedef enum {
-	PWM,
-#ifdef RADIO_USE_PPM
-    PPM,
-#endif
-#ifdef RADIO_USE_IBUS
-    IBUS,
-#endif
-#ifdef RADIO_USE_SBUS
-    SBUS,
-#endif
-#ifdef RADIO_USE_CRSF
-    CRSF,
-#endif
-	RADIO_NUM_PROTOCOL,
-} RADIO_protocol_t;
-
-typedef enum {
-    CH1,  CH2,  CH3,  CH4,
-    CH5,  CH6,  CH7,  CH8,
-    CH9,  CH10, CH11, CH12,
-    CH13, CH14, CH15, CH16
-} RADIO_chIndex_t;
-
-typedef enum {
-    chOFF,
-    chFWD,
-    chRVS
-} RADIO_chActive_t;
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-RADIO_protocol_t	RADIO_Init 				( RADIO_protocol_t );
-void 				RADIO_Update 			( void );
-
-uint32_t* 			RADIO_getData 			( void );
-bool* 				RADIO_getInputLost 		( void );
-uint8_t 			RADIO_getChCount		( void );
-RADIO_chActive_t* 	RADIO_getChActiveCount 	( void );
-uint8_t 			RADIO_getChValidCount 	( void );
-
-bool 				RADIO_inFaultStateCH   	( RADIO_chIndex_t );
-bool 				RADIO_inFaultStateALL	( void );
-bool 				RADIO_inFaultStateANY	( void );
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EXTERN DECLARATIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#endif /* RADIO_H */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef RADIO_H
+#define RADIO_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+#include "Core.h"
+#include "US.h"
+#ifndef RADIO_NO_PWM
+#include "PWM.h"
+#endif
+#ifdef RADIO_USE_AUTOBAUD
+#include "Autobaud.h"
+#endif
+#ifdef RADIO_USE_PPM
+#include "PPM.h"
+#endif
+#ifdef RADIO_USE_IBUS
+#include "IBUS.h"
+#endif
+#ifdef RADIO_USE_SBUS
+#include "SBUS.h"
+#endif
+#ifdef RADIO_USE_CRSF
+#include "CRSF.h"
+#endif
+#ifdef RADIO_USE_MIXER
+#include "Mixer.h"
+#endif
+#ifdef RADIO_USE_CALIBRATION
+#include "Calib.h"
+#endif
+#ifdef RADIO_USE_SMOOTHING
+#include "Smooth.h"
+#endif
+#ifdef RADIO_USE_FILTER
+#include "Filter.h"
+#endif
+#ifdef RADIO_USE_FAILSAFE
+#include "Failsafe.h"
+#endif
+#ifdef RADIO_USE_STORAGE
+#include "Storage.h"
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#define RADIO_MIN(X, Y)    	(((X) < (Y)) ? (X) : (Y))
+#define RADIO_MAX(X, Y)		(((X) > (Y)) ? (X) : (Y))
+
+#if !defined(RADIO_NO_PWM) + defined(RADIO_USE_PPM) + defined(RADIO_USE_IBUS) + defined(RADIO_USE_SBUS) + defined(RADIO_USE_CRSF) == 0
+#error "error: RADIO_NO_PWM needs at least one RADIO_USE_* protocol enabled"
+#endif
+
+#ifndef RADIO_NO_PWM
+  #define RADIO_CH_NUM_BASE PWM_CH_NUM
+#else
+  #define RADIO_CH_NUM_BASE 0
+#endif
+#ifdef RADIO_USE_PPM
+  #define RADIO_CH_NUM_PPM  RADIO_MAX(PPM_CH_NUM, RADIO_CH_NUM_BASE)
+#else
+  #define RADIO_CH_NUM_PPM  RADIO_CH_NUM_BASE
+#endif
+#ifdef RADIO_USE_IBUS
+  #define RADIO_CH_NUM_IBUS RADIO_MAX(IBUS_CH_NUM, RADIO_CH_NUM_PPM)
+#else
+  #define RADIO_CH_NUM_IBUS RADIO_CH_NUM_PPM
+#endif
+#ifdef RADIO_USE_SBUS
+  #define RADIO_CH_NUM_SBUS RADIO_MAX(SBUS_CH_NUM, RADIO_CH_NUM_IBUS)
+#else
+  #define RADIO_CH_NUM_SBUS RADIO_CH_NUM_IBUS
+#endif
+#ifdef RADIO_USE_CRSF
+  #define RADIO_CH_NUM_MAX  RADIO_MAX(CRSF_CH_NUM, RADIO_CH_NUM_SBUS)
+#else
+  #define RADIO_CH_NUM_MAX  RADIO_CH_NUM_SBUS
+#endif
+
+/* Channel fault flags are a bit per channel, so a protocol can carry up to 32 */
+#define RADIO_CH_NUM_LIMIT	32
+#if RADIO_CH_NUM_MAX > RADIO_CH_NUM_LIMIT
+#error "error: a protocol has more than RADIO_CH_NUM_LIMIT channels"
+#endif
+#define RADIO_CH_MASK(n)	((uint32_t)(((uint64_t)1 << (n)) - 1))	/* Bits of the first n channels */
+
+#define RADIO_CH_MIN        1000
+#define RADIO_CH_MAX        2000
+#define RADIO_CH_CENTER     1500 //((RADIO_CH_MAX - RADIO_CH_MIN) / 2) //1500
+#define RADIO_CH_FULLSCALE 	1000 //(RADIO_CH_MAX - RADIO_CH_MIN)
+#define RADIO_CH_HALFSCALE	500 //(RADIO_CH_FULLSCALE / 2)
+
+/* Q15 of v between min and max: -RADIO_Q15_ONE at min, 0 halfway, RADIO_Q15_ONE at max.
+   With constant bounds this is a multiply and a shift, no divide */
+#define RADIO_Q15_ONE		32767
+#define RADIO_Q15(v, min, max)	((int16_t)(((2 * (int32_t)(v) - (int32_t)((min) + (max))) \
+								* (((int32_t)RADIO_Q15_ONE << 15) / ((max) - (min))) + (1 << 14)) >> 15))
+
+#define RADIO_CH_STRETCH    300
+#define RADIO_CH_ERROR      50
+#define RADIO_CH_DEADBAND   50
+
+#define RADIO_CH_ABSMIN     (RADIO_CH_MIN    - RADIO_CH_STRETCH - RADIO_CH_ERROR)
+#define RADIO_CH_ABSMAX     (RADIO_CH_MAX    + RADIO_CH_STRETCH + RADIO_CH_ERROR)
+#define RADIO_CH_CENTERMIN  (RADIO_CH_CENTER - RADIO_CH_DEADBAND)
+#define RADIO_CH_CENTERMAX	(RADIO_CH_CENTER + RADIO_CH_DEADBAND)
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef enum {
+#ifndef RADIO_NO_PWM
+	PWM,
+#endif
+#ifdef RADIO_USE_PPM
+    PPM,
+#endif
+#ifdef RADIO_USE_IBUS
+    IBUS,
+#endif
+#ifdef RADIO_USE_SBUS
+    SBUS,
+#endif
+#ifdef RADIO_USE_CRSF
+    CRSF,
+#endif
+	RADIO_NUM_PROTOCOL,
+} RADIO_protocol_t;
+
+typedef enum {
+    CH1,  CH2,  CH3,  CH4,
+    CH5,  CH6,  CH7,  CH8,
+    CH9,  CH10, CH11, CH12,
+    CH13, CH14, CH15, CH16,
+    CH17, CH18, CH19, CH20,
+    CH21, CH22, CH23, CH24,
+    CH25, CH26, CH27, CH28,
+    CH29, CH30, CH31, CH32
+} RADIO_chIndex_t;
+
+/* Bit per channel, CH1 in bit 0 */
+typedef uint32_t RADIO_chMask_t;
+
+typedef enum {
+    chOFF,
+    chFWD,
+    chRVS
+} RADIO_chActive_t;
+
+typedef enum {
+	RADIO_Detect_Idle,		/* RADIO_Init not yet called						*/
+	RADIO_Detect_Autobaud,	/* Measuring RX line baud rate and polarity			*/
+	RADIO_Detect_Searching,	/* Cycling through candidate protocols				*/
+	RADIO_Detect_Fallback,	/* No protocol found, running 'initial' until input	*/
+	RADIO_Detect_Locked,	/* Valid input found, protocol fixed				*/
+} RADIO_detectState_t;
+
+typedef enum {
+	RADIO_Input_Primary,	/* Started by RADIO_Init, runs protocol detection	*/
+	RADIO_Input_Secondary,	/* Started by RADIO_InitSecondary					*/
+} RADIO_input_t;
+
+/* Last configuration that locked, persisted through RADIO_storage_t */
+typedef struct {
+	uint8_t		protocol;	/* RADIO_protocol_t							*/
+	uint8_t		inverted;	/* Serial line idles low					*/
+	uint8_t		chCount;
+	uint8_t		check;		/* Integrity byte, maintained by the library	*/
+	uint32_t	baud;		/* 0 for non-serial protocols				*/
+	uint32_t	periodMs;	/* Frame period								*/
+} RADIO_lastGood_t;
+
+/* Persistence backend (e.g flash/EEPROM page). All return false on failure, any may be NULL */
+typedef struct {
+	bool 		( *load )( RADIO_lastGood_t * );
+	bool 		( *save )( const RADIO_lastGood_t * );
+#ifdef RADIO_USE_CALIBRATION
+	bool 		( *loadCal )( CALIB_record_t * );
+	bool 		( *saveCal )( const CALIB_record_t * );
+#endif
+} RADIO_storage_t;
+
+/* Consistent copy of the outputs for other tasks, see RADIO_getSnapshot */
+typedef struct {
+	uint32_t		seq;					/* Incremented for every snapshot, 0 if none yet	*/
+	uint32_t		frameSeq;				/* RADIO_getFrameSeq() of the channels				*/
+	uint32_t		frameTime;				/* RADIO_getFrameTime() of the channels				*/
+	RADIO_input_t	input;					/* Input the frame came from						*/
+	uint8_t			chCount;
+	bool 			inputLost;				/* No valid channels								*/
+	RADIO_chMask_t	chLost;					/* Channels without valid input						*/
+	RADIO_chMask_t	chChanged;				/* See RADIO_getChChanged()							*/
+	uint16_t		ch[RADIO_CH_NUM_MAX];
+} RADIO_snapshot_t;
+
+/* Functions every protocol provides, as the X_ops table in its module. ctx is the input's X_t */
+typedef struct {
+	uint8_t		chCount;
+	bool 		( *init )( void * ctx, uint32_t baud, bool inverted );	/* False if it could not start, e.g no instance free	*/
+	void 		( *deinit )( void * ctx );
+	bool 		( *detect )( void * ctx );
+	void 		( *update )( void * ctx );
+	uint16_t*	( *getData )( void * ctx );
+#ifdef RADIO_LAZY_DECODE
+	void 		( *subscribe )( void * ctx, uint32_t );	/* Channels to unpack, NULL if decoded in one piece			*/
+#endif
+#ifdef RADIO_USE_HIRES
+	int16_t*	( *getNormalised )( void * ctx );	/* Q15 of getData at the protocol's resolution				*/
+	uint16_t*	( *getRaw )( void * ctx );			/* Protocol values as received								*/
+#endif
+	uint32_t	( *getInputLost )( void * ctx );		/* Lost channels, see RADIO_chMask_t						*/
+	uint32_t	( *getFrameCount )( void * ctx );
+	uint32_t	( *getFrameTime )( void * ctx );
+	uint8_t		( *getLinkQuality )( void * ctx );
+	void 		( *onFrame )( void * ctx, void (*)(void) );
+	void 		( *rxByte )( void * ctx, uint8_t );	/* Serial protocols with RADIO_PARSE/RX_IN_IRQ, else NULL	*/
+} RADIO_ops_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void 				RADIO_setStorage		( const RADIO_storage_t * );
+RADIO_protocol_t	RADIO_Init 				( RADIO_protocol_t );
+bool 				RADIO_InitSecondary		( RADIO_protocol_t );
+void 				RADIO_Deinit 			( void );
+void 				RADIO_DeinitSecondary	( void );
+void 				RADIO_Update 			( void );
+
+RADIO_protocol_t	RADIO_getProtocol		( void );
+RADIO_detectState_t	RADIO_getDetectState	( void );
+void 				RADIO_OnLock			( void (*)(RADIO_protocol_t) );
+
+void 				RADIO_OnFrame			( void (*)(RADIO_input_t) );
+bool 				RADIO_getFrameEvent		( void );
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+void 				RADIO_RX_IRQ			( RADIO_input_t, uint8_t );
+#endif
+
+RADIO_input_t		RADIO_getActiveInput	( void );
+uint8_t 			RADIO_getLinkQuality	( void );
+
+bool 				RADIO_getSnapshot		( RADIO_snapshot_t * );
+uint32_t 			RADIO_getSnapshotSeq	( void );
+
+uint16_t* 			RADIO_getData 			( void );
+#ifdef RADIO_USE_HIRES
+int16_t* 			RADIO_getNormalised		( void );
+uint16_t* 			RADIO_getRaw			( void );
+#endif
+uint32_t 			RADIO_getFrameSeq		( void );
+uint32_t 			RADIO_getFrameTime		( void );
+uint32_t 			RADIO_getDataAge		( void );
+RADIO_chMask_t		RADIO_getInputLost 		( void );
+uint8_t 			RADIO_getChCount		( void );
+RADIO_chActive_t* 	RADIO_getChActiveCount 	( void );
+uint8_t 			RADIO_getChValidCount 	( void );
+RADIO_chMask_t		RADIO_getChChanged		( void );
+bool 				RADIO_isFrameIdentical	( void );
+
+bool 				RADIO_inFaultStateCH   	( RADIO_chIndex_t );
+bool 				RADIO_inFaultStateALL	( void );
+bool 				RADIO_inFaultStateANY	( void );
+
+#ifdef RADIO_USE_CALIBRATION
+void 				RADIO_calibrateStart	( void );
+bool 				RADIO_calibrateFinish	( void );
+bool 				RADIO_isCalibrating		( void );
+#endif
+
+#ifdef RADIO_LAZY_DECODE
+void 				RADIO_Subscribe			( RADIO_chMask_t );
+#endif
+
+#ifdef RADIO_USE_FILTER
+void 				RADIO_setFilter			( const FILTER_channel_t *, uint8_t );
+#endif
+
+#ifdef RADIO_USE_FAILSAFE
+void 				RADIO_setFailsafe		( const FAILSAFE_channel_t *, uint8_t, uint32_t );
+FAILSAFE_stage_t	RADIO_getFailsafe		( void );
+#endif
+
+#ifdef RADIO_USE_SMOOTHING
+uint16_t* 			RADIO_getSmoothed		( void );
+int32_t* 			RADIO_getDerivative		( void );
+uint32_t 			RADIO_getFrameInterval	( void );
+#endif
+
+#ifdef RADIO_USE_MIXER
+void 				RADIO_setMixer			( const MIXER_channel_t *, uint8_t );
+int16_t* 			RADIO_getMixed			( void );
+uint8_t 			RADIO_getMixedCount		( void );
+#endif
+
+uint32_t 			RADIO_getRamSize		( void );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#ifndef RADIO_NO_PWM
+extern const RADIO_ops_t PWM_ops;
+#endif
+#ifdef RADIO_USE_PPM
+extern const RADIO_ops_t PPM_ops;
+#endif
+#ifdef RADIO_USE_IBUS
+extern const RADIO_ops_t IBUS_ops;
+#endif
+#ifdef RADIO_USE_SBUS
+extern const RADIO_ops_t SBUS_ops;
+#endif
+#ifdef RADIO_USE_CRSF
+extern const RADIO_ops_t CRSF_ops;
+#endif
+#ifdef RADIO_USE_STORAGE
+extern const RADIO_storage_t STORAGE_ops;
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* RADIO_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
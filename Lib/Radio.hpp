@@ -0,0 +1,471 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef RADIO_HPP
+#define RADIO_HPP
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * C++17 front end to the protocol decoders, header only.
+ *
+ *  radio::Receiver<radio::Crsf> rx;				// One protocol - direct calls
+ *  radio::Receiver<radio::Sbus, radio::Pwm> rx2;	// Several - switch on the running one
+ *
+ *  rx.begin<radio::Crsf>( UART_1 );
+ *  rx.update();
+ *  radio::Micros throttle = rx.us( radio::Channel::CH3 );
+ *
+ * The protocols available are the ones enabled with RADIO_NO_PWM / RADIO_USE_*, as
+ * for the C API. Each Receiver owns one work area sized for the largest of its
+ * protocols, and does not use Radio.c (no detection or input selection).
+ */
+
+extern "C" {
+#include "Radio.h"
+}
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+namespace radio {
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+enum class Channel : uint8_t {
+	CH1,  CH2,  CH3,  CH4,
+	CH5,  CH6,  CH7,  CH8,
+	CH9,  CH10, CH11, CH12,
+	CH13, CH14, CH15, CH16,
+	CH17, CH18, CH19, CH20,
+	CH21, CH22, CH23, CH24,
+	CH25, CH26, CH27, CH28,
+	CH29, CH30, CH31, CH32,
+};
+
+/* Pulse width as output by every decoder, RADIO_CH_MIN to RADIO_CH_MAX. 0 if never received */
+struct Micros {
+	uint16_t value;
+	constexpr explicit Micros ( uint16_t us ) : value( us ) {}
+};
+
+/* Stick position in Q15, -32767 at RADIO_CH_MIN, 0 at RADIO_CH_CENTER, 32767 at RADIO_CH_MAX */
+struct Normalised {
+	int16_t value;
+	constexpr explicit Normalised ( int16_t q15 ) : value( q15 ) {}
+};
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+constexpr uint8_t index ( Channel c )
+{
+	return static_cast<uint8_t>( c );
+}
+
+constexpr Normalised normalise ( Micros us )
+{
+	int32_t q15 = ( (int32_t)us.value - RADIO_CH_CENTER ) * INT16_MAX / RADIO_CH_HALFSCALE;
+	return Normalised( (int16_t)( q15 > INT16_MAX ? INT16_MAX : q15 < -INT16_MAX ? -INT16_MAX : q15 ) );
+}
+
+constexpr Micros toMicros ( Normalised n )
+{
+	return Micros( (uint16_t)( RADIO_CH_CENTER + (int32_t)n.value * RADIO_CH_HALFSCALE / INT16_MAX ) );
+}
+
+static_assert( normalise( Micros(RADIO_CH_MIN) ).value == -INT16_MAX, "RADIO_CH_MIN must map to -1.0" );
+static_assert( normalise( Micros(RADIO_CH_MAX) ).value == INT16_MAX, "RADIO_CH_MAX must map to 1.0" );
+static_assert( toMicros( Normalised(0) ).value == RADIO_CH_CENTER, "0 must map to RADIO_CH_CENTER" );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PROTOCOLS											*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * One tag per decoder, binding its X_t and X_* functions. begin() takes what the
+ * decoder's X_Init() binds to: a UART for serial protocols, a pin and timer for PPM,
+ * PWM_CH_NUM pins and a timer for PWM.
+ */
+
+#ifndef RADIO_NO_PWM
+struct Pwm {
+	using Context = PWM_t;
+	static constexpr RADIO_protocol_t	id			= PWM;
+	static constexpr uint8_t			channels	= PWM_CH_NUM;
+
+	static bool begin ( Context & c, const uint32_t * pins, TIM_t * tim )	{ return PWM_Init( &c, pins, tim ); }
+	static void end ( Context & c )											{ PWM_Deinit( &c ); }
+	static bool detect ( Context & c )										{ return PWM_Detect( &c ); }
+	static void update ( Context & c )										{ PWM_Update( &c ); }
+	static const uint16_t * data ( Context & c )							{ return PWM_getData( &c ); }
+#ifdef RADIO_USE_HIRES
+	static const int16_t * norm ( Context & c )							{ return PWM_getNormalised( &c ); }
+	static const uint16_t * raw ( Context & c )							{ return PWM_getRaw( &c ); }
+#endif
+	static uint32_t lost ( Context & c )									{ return PWM_getInputLost( &c ); }
+	static uint32_t frameCount ( Context & c )								{ return PWM_getFrameCount( &c ); }
+	static uint32_t frameTime ( Context & c )								{ return PWM_getFrameTime( &c ); }
+	static uint8_t linkQuality ( Context & c )								{ return PWM_getLinkQuality( &c ); }
+	static void onFrame ( Context & c, void (*callback)(void) )				{ PWM_OnFrame( &c, callback ); }
+	static void rxByte ( Context &, uint8_t )								{}
+};
+#endif
+
+#ifdef RADIO_USE_PPM
+struct Ppm {
+	using Context = PPM_t;
+	static constexpr RADIO_protocol_t	id			= PPM;
+	static constexpr uint8_t			channels	= PPM_CH_NUM;
+
+	static bool begin ( Context & c, uint32_t pin, TIM_t * tim )			{ return PPM_Init( &c, pin, tim ); }
+	static void end ( Context & c )											{ PPM_Deinit( &c ); }
+	static bool detect ( Context & c )										{ return PPM_Detect( &c ); }
+	static void update ( Context & c )										{ PPM_Update( &c ); }
+	static const uint16_t * data ( Context & c )							{ return PPM_getData( &c ); }
+#ifdef RADIO_USE_HIRES
+	static const int16_t * norm ( Context & c )							{ return PPM_getNormalised( &c ); }
+	static const uint16_t * raw ( Context & c )							{ return PPM_getRaw( &c ); }
+#endif
+	static uint32_t lost ( Context & c )									{ return PPM_getInputLost( &c ); }
+	static uint32_t frameCount ( Context & c )								{ return PPM_getFrameCount( &c ); }
+	static uint32_t frameTime ( Context & c )								{ return PPM_getFrameTime( &c ); }
+	static uint8_t linkQuality ( Context & c )								{ return PPM_getLinkQuality( &c ); }
+	static void onFrame ( Context & c, void (*callback)(void) )				{ PPM_OnFrame( &c, callback ); }
+	static void rxByte ( Context &, uint8_t )								{}
+};
+#endif
+
+#ifdef RADIO_USE_IBUS
+struct Ibus {
+	using Context = IBUS_t;
+	static constexpr RADIO_protocol_t	id			= IBUS;
+	static constexpr uint8_t			channels	= IBUS_CH_NUM;
+
+	static bool begin ( Context & c, UART_t * uart, uint32_t baud = IBUS_BAUD, bool inverted = false )
+																			{ IBUS_Init( &c, uart, baud, inverted ); return true; }
+	static void end ( Context & c )											{ IBUS_Deinit( &c ); }
+	static bool detect ( Context & c )										{ return IBUS_Detect( &c ); }
+	static void update ( Context & c )										{ IBUS_Update( &c ); }
+	static const uint16_t * data ( Context & c )							{ return IBUS_getData( &c ); }
+#ifdef RADIO_USE_HIRES
+	static const int16_t * norm ( Context & c )							{ return IBUS_getNormalised( &c ); }
+	static const uint16_t * raw ( Context & c )							{ return IBUS_getRaw( &c ); }
+#endif
+	static uint32_t lost ( Context & c )									{ return IBUS_getInputLost( &c ); }
+	static uint32_t frameCount ( Context & c )								{ return IBUS_getFrameCount( &c ); }
+	static uint32_t frameTime ( Context & c )								{ return IBUS_getFrameTime( &c ); }
+	static uint8_t linkQuality ( Context & c )								{ return IBUS_getLinkQuality( &c ); }
+	static void onFrame ( Context & c, void (*callback)(void) )				{ IBUS_OnFrame( &c, callback ); }
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+	static void rxByte ( Context & c, uint8_t byte )						{ IBUS_RX_IRQ( &c, byte ); }
+#else
+	static void rxByte ( Context &, uint8_t )								{}
+#endif
+};
+#endif
+
+#ifdef RADIO_USE_SBUS
+struct Sbus {
+	using Context = SBUS_t;
+	static constexpr RADIO_protocol_t	id			= SBUS;
+	static constexpr uint8_t			channels	= SBUS_CH_NUM;
+
+	static bool begin ( Context & c, UART_t * uart, uint32_t baud = SBUS_BAUD, bool inverted = true )
+																			{ SBUS_Init( &c, uart, baud, inverted ); return true; }
+	static void end ( Context & c )											{ SBUS_Deinit( &c ); }
+	static bool detect ( Context & c )										{ return SBUS_Detect( &c ); }
+	static void update ( Context & c )										{ SBUS_Update( &c ); }
+	static const uint16_t * data ( Context & c )							{ return SBUS_getData( &c ); }
+#ifdef RADIO_USE_HIRES
+	static const int16_t * norm ( Context & c )							{ return SBUS_getNormalised( &c ); }
+	static const uint16_t * raw ( Context & c )							{ return SBUS_getRaw( &c ); }
+#endif
+	static uint32_t lost ( Context & c )									{ return SBUS_getInputLost( &c ); }
+	static uint32_t frameCount ( Context & c )								{ return SBUS_getFrameCount( &c ); }
+	static uint32_t frameTime ( Context & c )								{ return SBUS_getFrameTime( &c ); }
+	static uint8_t linkQuality ( Context & c )								{ return SBUS_getLinkQuality( &c ); }
+	static void onFrame ( Context & c, void (*callback)(void) )				{ SBUS_OnFrame( &c, callback ); }
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+	static void rxByte ( Context & c, uint8_t byte )						{ SBUS_RX_IRQ( &c, byte ); }
+#else
+	static void rxByte ( Context &, uint8_t )								{}
+#endif
+};
+#endif
+
+#ifdef RADIO_USE_CRSF
+struct Crsf {
+	using Context = CRSF_t;
+	static constexpr RADIO_protocol_t	id			= CRSF;
+	static constexpr uint8_t			channels	= CRSF_CH_NUM;
+
+	static bool begin ( Context & c, UART_t * uart, uint32_t baud = CRSF_BAUD, bool inverted = false )
+																			{ CRSF_Init( &c, uart, baud, inverted ); return true; }
+	static void end ( Context & c )											{ CRSF_Deinit( &c ); }
+	static bool detect ( Context & c )										{ return CRSF_Detect( &c ); }
+	static void update ( Context & c )										{ CRSF_Update( &c ); }
+	static const uint16_t * data ( Context & c )							{ return CRSF_getData( &c ); }
+#ifdef RADIO_USE_HIRES
+	static const int16_t * norm ( Context & c )							{ return CRSF_getNormalised( &c ); }
+	static const uint16_t * raw ( Context & c )							{ return CRSF_getRaw( &c ); }
+#endif
+	static uint32_t lost ( Context & c )									{ return CRSF_getInputLost( &c ); }
+	static uint32_t frameCount ( Context & c )								{ return CRSF_getFrameCount( &c ); }
+	static uint32_t frameTime ( Context & c )								{ return CRSF_getFrameTime( &c ); }
+	static uint8_t linkQuality ( Context & c )								{ return CRSF_getLinkQuality( &c ); }
+	static void onFrame ( Context & c, void (*callback)(void) )				{ CRSF_OnFrame( &c, callback ); }
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+	static void rxByte ( Context & c, uint8_t byte )						{ CRSF_RX_IRQ( &c, byte ); }
+#else
+	static void rxByte ( Context &, uint8_t )								{}
+#endif
+};
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* RECEIVER												*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+namespace detail {
+
+template <typename T> struct Tag { using type = T; };
+
+template <typename First, typename...> struct Front { using type = First; };
+
+template <typename T, typename First, typename... Rest>
+constexpr uint8_t indexOf ()
+{
+	if constexpr ( std::is_same<T, First>::value ) {
+		return 0;
+	} else {
+		return 1 + indexOf<T, Rest...>();
+	}
+}
+
+template <typename... P>
+constexpr uint8_t maxChannels ()
+{
+	uint8_t n = 0;
+	( ( n = P::channels > n ? P::channels : n ), ... );
+	return n;
+}
+
+template <typename... P>
+constexpr size_t maxSize ()
+{
+	size_t n = 0;
+	( ( n = sizeof(typename P::Context) > n ? sizeof(typename P::Context) : n ), ... );
+	return n;
+}
+
+} // namespace detail
+
+/*
+ * Receiver
+ *  - Runs one of the listed protocols at a time. Calls go straight to the running
+ *    decoder, through a switch when there is more than one protocol to choose from.
+ *  - Not copyable: the decoders keep pointers into their context.
+ */
+template <typename... P>
+class Receiver
+{
+	static_assert( sizeof...(P) >= 1, "Receiver needs at least one protocol" );
+
+public:
+	/* Most channels of any of the protocols */
+	static constexpr uint8_t channels = detail::maxChannels<P...>();
+
+	Receiver () = default;
+	Receiver ( const Receiver & ) = delete;
+	Receiver & operator= ( const Receiver & ) = delete;
+	~Receiver () { end(); }
+
+	/*
+	 * begin
+	 *  - Stops any running protocol, then starts T with the binding its tag takes.
+	 *  - Returns false if the decoder could not start (e.g no free pin handler).
+	 */
+	template <typename T, typename... Args>
+	bool begin ( Args... args )
+	{
+		static_assert( (std::is_same<T, P>::value || ...), "protocol is not one of this Receiver's" );
+		end();
+		active	= detail::indexOf<T, P...>();
+		running	= T::begin( context<T>(), args... );
+		return running;
+	}
+
+	void end ()
+	{
+		if ( !running ) { return; }
+		running = false;
+		dispatch( [this]( auto tag ) { using T = typename decltype(tag)::type; T::end( context<T>() ); } );
+	}
+
+	bool isRunning () const { return running; }
+
+	template <typename T>
+	bool is () const { return running && active == detail::indexOf<T, P...>(); }
+
+	RADIO_protocol_t protocol () const
+	{
+		return dispatch( []( auto tag ) { return decltype(tag)::type::id; } );
+	}
+
+	/* Non-blocking. True once the running protocol is receiving valid input */
+	bool detect ()
+	{
+		if ( !running ) { return false; }
+		return dispatch( [this]( auto tag ) { using T = typename decltype(tag)::type; return T::detect( context<T>() ); } );
+	}
+
+	/* Poll every ~1ms, as X_Update() */
+	void update ()
+	{
+		if ( !running ) { return; }
+		dispatch( [this]( auto tag ) { using T = typename decltype(tag)::type; T::update( context<T>() ); } );
+	}
+
+	/* Channels of the running protocol */
+	uint8_t channelCount () const
+	{
+		if ( !running ) { return 0; }
+		return dispatch( []( auto tag ) { return decltype(tag)::type::channels; } );
+	}
+
+	/* Micros(0) for a channel the running protocol does not carry */
+	Micros us ( Channel c ) const
+	{
+		if ( index(c) >= channelCount() ) { return Micros( 0 ); }
+		return Micros( data()[ index(c) ] );
+	}
+
+	/* As us(), with the channel checked against every protocol at compile time */
+	template <Channel C>
+	Micros us () const
+	{
+		static_assert( index(C) < channels, "no protocol of this Receiver carries the channel" );
+		return us( C );
+	}
+
+#ifdef RADIO_USE_HIRES
+	/* At the full resolution of the protocol rather than through microseconds */
+	Normalised normalised ( Channel c ) const
+	{
+		if ( !running || index(c) >= channelCount() ) { return Normalised( 0 ); }
+		return Normalised( dispatch( [this]( auto tag ) { using T = typename decltype(tag)::type; return T::norm( context<T>() ); } )[ index(c) ] );
+	}
+
+	template <Channel C>
+	Normalised normalised () const
+	{
+		static_assert( index(C) < channels, "no protocol of this Receiver carries the channel" );
+		return normalised( C );
+	}
+
+	/* Protocol value as received, 0 for a channel the running protocol does not carry */
+	uint16_t raw ( Channel c ) const
+	{
+		if ( !running || index(c) >= channelCount() ) { return 0; }
+		return dispatch( [this]( auto tag ) { using T = typename decltype(tag)::type; return T::raw( context<T>() ); } )[ index(c) ];
+	}
+#else
+	Normalised normalised ( Channel c ) const
+	{
+		return normalise( us(c) );
+	}
+
+	template <Channel C>
+	Normalised normalised () const
+	{
+		return normalise( us<C>() );
+	}
+#endif
+
+	/* Bit per channel, CH1 in bit 0. All set if nothing is running */
+	RADIO_chMask_t lostMask () const
+	{
+		if ( !running ) { return RADIO_CH_MASK(channels); }
+		return dispatch( [this]( auto tag ) { using T = typename decltype(tag)::type; return T::lost( context<T>() ); } );
+	}
+
+	bool lost ( Channel c ) const
+	{
+		return index(c) >= channelCount() || ( ( lostMask() >> index(c) ) & 1 );
+	}
+
+	uint32_t frameCount () const
+	{
+		if ( !running ) { return 0; }
+		return dispatch( [this]( auto tag ) { using T = typename decltype(tag)::type; return T::frameCount( context<T>() ); } );
+	}
+
+	uint32_t frameTime () const
+	{
+		if ( !running ) { return 0; }
+		return dispatch( [this]( auto tag ) { using T = typename decltype(tag)::type; return T::frameTime( context<T>() ); } );
+	}
+
+	uint8_t linkQuality () const
+	{
+		if ( !running ) { return 0; }
+		return dispatch( [this]( auto tag ) { using T = typename decltype(tag)::type; return T::linkQuality( context<T>() ); } );
+	}
+
+	/* Fired from interrupt context for each frame. Register after begin() */
+	void onFrame ( void (*callback)(void) )
+	{
+		if ( !running ) { return; }
+		dispatch( [this, callback]( auto tag ) { using T = typename decltype(tag)::type; T::onFrame( context<T>(), callback ); } );
+	}
+
+	/* With RADIO_PARSE_IN_IRQ or RADIO_RX_IN_IRQ, call from the UART RX interrupt */
+	void rxByte ( uint8_t byte )
+	{
+		if ( !running ) { return; }
+		dispatch( [this, byte]( auto tag ) { using T = typename decltype(tag)::type; T::rxByte( context<T>(), byte ); } );
+	}
+
+private:
+	alignas( typename P::Context... ) uint8_t storage[ detail::maxSize<P...>() ];
+	uint8_t active	= 0;
+	bool running	= false;
+
+	/* The C getters take a non-const context but only read it */
+	template <typename T>
+	typename T::Context & context () const
+	{
+		return *reinterpret_cast<typename T::Context *>( const_cast<uint8_t *>( storage ) );
+	}
+
+	const uint16_t * data () const
+	{
+		return dispatch( [this]( auto tag ) { using T = typename decltype(tag)::type; return T::data( context<T>() ); } );
+	}
+
+	/* Calls f with the Tag of the running protocol. Resolved at compile time for one protocol */
+	template <typename F>
+	auto dispatch ( F && f ) const
+	{
+		using First	= typename detail::Front<P...>::type;
+		using R		= decltype( f( detail::Tag<First>{} ) );
+
+		if constexpr ( sizeof...(P) == 1 ) {
+			return f( detail::Tag<First>{} );
+		} else if constexpr ( std::is_void<R>::value ) {
+			(void)( ( active == detail::indexOf<P, P...>() ? ( f( detail::Tag<P>{} ), true ) : false ) || ... );
+		} else {
+			R result{};
+			(void)( ( active == detail::indexOf<P, P...>() ? ( result = f( detail::Tag<P>{} ), true ) : false ) || ... );
+			return result;
+		}
+	}
+};
+
+} // namespace radio
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* RADIO_HPP */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
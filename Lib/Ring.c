@@ -0,0 +1,158 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Ring.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * RING_Init
+ *  - Empties the ring and binds it to buffer. Call with neither side running.
+ *  - Returns false if size is not a power of two.
+ */
+bool RING_Init ( RING_t * r, uint8_t * buffer, uint32_t size )
+{
+	if ( !RING_IS_POW2(size) ) { return false; }
+
+	r->buffer	= buffer;
+	r->mask		= size - 1;
+	r->head		= 0;
+	r->tail		= 0;
+
+	return true;
+}
+
+/*
+ * RING_Put
+ *  - Producer. Returns false (byte dropped) if the ring is full.
+ */
+bool RING_Put ( RING_t * r, uint8_t byte )
+{
+	uint32_t head = r->head;
+	if ( head - __atomic_load_n( &r->tail, __ATOMIC_ACQUIRE ) > r->mask ) { return false; }
+
+	r->buffer[head & r->mask] = byte;
+	__atomic_store_n( &r->head, head + 1, __ATOMIC_RELEASE );
+
+	return true;
+}
+
+/*
+ * RING_WriteSpan
+ *  - Producer. Free space that is contiguous from head, for a block copy
+ *    (e.g one UART_Read()). Follow with RING_Write() to publish the bytes.
+ */
+uint32_t RING_WriteSpan ( RING_t * r, uint8_t ** span )
+{
+	uint32_t head	= r->head;
+	uint32_t free	= (r->mask + 1) - (head - __atomic_load_n( &r->tail, __ATOMIC_ACQUIRE ));
+	uint32_t edge	= (r->mask + 1) - (head & r->mask);
+
+	*span = &r->buffer[head & r->mask];
+	return free < edge ? free : edge;
+}
+
+/*
+ * RING_Write
+ *  - Producer. Publishes n bytes written to the span from RING_WriteSpan().
+ */
+void RING_Write ( RING_t * r, uint32_t n )
+{
+	__atomic_store_n( &r->head, r->head + n, __ATOMIC_RELEASE );
+}
+
+/*
+ * RING_Count
+ *  - Consumer. Bytes waiting to be read.
+ */
+uint32_t RING_Count ( const RING_t * r )
+{
+	return __atomic_load_n( &r->head, __ATOMIC_ACQUIRE ) - r->tail;
+}
+
+/*
+ * RING_Peek
+ *  - Consumer. Byte at offset from tail without consuming it. offset must be
+ *    less than RING_Count().
+ */
+uint8_t RING_Peek ( const RING_t * r, uint32_t offset )
+{
+	return r->buffer[(r->tail + offset) & r->mask];
+}
+
+/*
+ * RING_ReadSpan
+ *  - Consumer. Waiting bytes that are contiguous from tail.
+ */
+uint32_t RING_ReadSpan ( const RING_t * r, const uint8_t ** span )
+{
+	uint32_t count	= RING_Count( r );
+	uint32_t edge	= (r->mask + 1) - (r->tail & r->mask);
+
+	*span = &r->buffer[r->tail & r->mask];
+	return count < edge ? count : edge;
+}
+
+/*
+ * RING_Linearise
+ *  - Consumer. The first n waiting bytes as one block. Points into the ring
+ *    when they are contiguous, otherwise they are copied to scratch.
+ *  - Valid until the bytes are skipped. n must not exceed RING_Count().
+ */
+const uint8_t* RING_Linearise ( const RING_t * r, uint8_t * scratch, uint32_t n )
+{
+	const uint8_t * span;
+	if ( RING_ReadSpan( r, &span ) >= n ) { return span; }
+
+	for ( uint32_t i = 0; i < n; i++ ) {
+		scratch[i] = RING_Peek( r, i );
+	}
+	return scratch;
+}
+
+/*
+ * RING_Skip
+ *  - Consumer. Commits (or discards) n bytes in one index update.
+ */
+void RING_Skip ( RING_t * r, uint32_t n )
+{
+	__atomic_store_n( &r->tail, r->tail + n, __ATOMIC_RELEASE );
+}
+
+/*
+ * RING_Flush
+ *  - Consumer. Discards everything waiting.
+ */
+void RING_Flush ( RING_t * r )
+{
+	__atomic_store_n( &r->tail, __atomic_load_n( &r->head, __ATOMIC_ACQUIRE ), __ATOMIC_RELEASE );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,55 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef RING_H
+#define RING_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Single producer, single consumer byte ring. The producer (e.g the UART RX
+ * interrupt) only moves head and the consumer only moves tail, so neither side
+ * needs a lock. Sizes must be a power of two.
+ */
+#define RING_IS_POW2(n)			((n) != 0 && ((n) & ((n) - 1)) == 0)
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef struct {
+	uint8_t *	buffer;
+	uint32_t	mask;		// Size - 1
+	uint32_t	head;		// Free running, written by the producer only
+	uint32_t	tail;		// Free running, written by the consumer only
+} RING_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+bool 			RING_Init		( RING_t *, uint8_t *, uint32_t );
+
+// Producer
+bool 			RING_Put		( RING_t *, uint8_t );
+uint32_t		RING_WriteSpan	( RING_t *, uint8_t ** );
+void 			RING_Write		( RING_t *, uint32_t );
+
+// Consumer
+uint32_t		RING_Count		( const RING_t * );
+uint8_t			RING_Peek		( const RING_t *, uint32_t );
+uint32_t		RING_ReadSpan	( const RING_t *, const uint8_t ** );
+const uint8_t*	RING_Linearise	( const RING_t *, uint8_t *, uint32_t );
+void 			RING_Skip		( RING_t *, uint32_t );
+void 			RING_Flush		( RING_t * );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* RING_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
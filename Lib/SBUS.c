@@ -1,321 +1,798 @@
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-#include "SBUS.h"
-
-#if defined(RADIO_USE_SBUS)
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-#define EMPTY				0
-
-#define SBUS_HEADER_LEN		1
-#define SBUS_DATA_LEN		22
-#define SBUS_AUX_LEN		1
-#define SBUS_FOOTER_LEN		1
-#define SBUS_PAYLOAD_LEN	(SBUS_HEADER_LEN + SBUS_DATA_LEN + SBUS_AUX_LEN + SBUS_FOOTER_LEN)
-
-#define SBUS_HEADER_INDEX	0
-#define SBUS_DATA_INDEX		(SBUS_HEADER_INDEX + SBUS_HEADER_LEN)
-#define SBUS_AUX_INDEX		(SBUS_DATA_INDEX + SBUS_DATA_LEN)
-#define SBUS_FOOTER_INDEX	(SBUS_AUX_INDEX + SBUS_AUX_LEN)
-
-#define SBUS_HEADER			0x0F
-#define SBUS_FOOTER			0x00
-#define SBUS_CH17_MASK		0x01
-#define SBUS_CH18_MASK		0x02
-#define SBUS_LOSTFRAME_MASK	0x04
-#define SBUS_FAILSAFE_MASK	0x08
-
-#define SBUS_THRESHOLD		500
-#define SBUS_DROPPED_FRAMES	3
-#define SBUS_TIMEOUT_FS		(SBUS_PERIOD * SBUS_DROPPED_FRAMES)
-#define SBUS_TIMEOUT_IP		4
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE TYPES										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE PROTOTYPES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-uint16_t	SBUS_Transform 	( uint16_t );
-void 		SBUS_HandleUART	( void );
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE VARIABLES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-uint8_t rxSBUS[2*SBUS_PAYLOAD_LEN] = {0};
-bool rxHeartbeatSBUS = false;
-SBUS_Data dataSBUS = {0};
-
-uint32_t baudConfig = 0;
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void SBUS_Init ( uint32_t baud )
-{
-	memset(rxSBUS, 0, sizeof(rxSBUS));
-	rxHeartbeatSBUS = false;
-	dataSBUS.inputLost = true;
-	baudConfig = baud;
-
-	UART_Init(SBUS_UART, baud, UART_Mode_Inverted);
-	UART_ReadFlush(SBUS_UART);
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void SBUS_Deinit ( void )
-{
-	UART_Deinit(SBUS_UART);
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-bool SBUS_Detect ( void )
-{
-	// First Try initialisation at SBUS_BAUD rate
-	SBUS_Init(SBUS_BAUD);
-
-	uint32_t tick = CORE_GetTick();
-	while ((SBUS_TIMEOUT_FS * 2) > CORE_GetTick() - tick)
-	{
-		SBUS_Update();
-		CORE_Idle();
-	}
-
-	// If  unsuccessful try at SBUS_BAUD_FAST
-	if ( dataSBUS.inputLost )
-	{
-		SBUS_Deinit();
-
-		SBUS_Init(SBUS_BAUD_FAST);
-
-		uint32_t tick = CORE_GetTick();
-		while ((SBUS_TIMEOUT_FS * 2) > CORE_GetTick() - tick)
-		{
-			SBUS_Update();
-			CORE_Idle();
-		}
-
-		if ( dataSBUS.inputLost )
-		{
-			SBUS_Deinit();
-		}
-	}
-
-	return !dataSBUS.inputLost;
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void SBUS_Update ( void )
-{
-	// Update Rx Data
-	SBUS_HandleUART();
-
-	// Init Loop Variables
-	uint32_t now = CORE_GetTick();
-	static uint32_t prev = 0;
-
-	// Check for New Input Data
-	if (rxHeartbeatSBUS)
-	{
-		// Decode SBUS Data
-		dataSBUS.ch[0]  = SBUS_Transform( (int16_t)( (rxSBUS[1]	   	  | rxSBUS[2] << 8 ) 					 & 0x07FF) );
-		dataSBUS.ch[1]  = SBUS_Transform( (int16_t)( (rxSBUS[2]  >> 3 | rxSBUS[3] << 5 ) 					 & 0x07FF) );
-		dataSBUS.ch[2]  = SBUS_Transform( (int16_t)( (rxSBUS[3]  >> 6 | rxSBUS[4] << 2  | rxSBUS[5] << 10 ) & 0x07FF) );
-		dataSBUS.ch[3]  = SBUS_Transform( (int16_t)( (rxSBUS[5]  >> 1 | rxSBUS[6] << 7 ) 					 & 0x07FF) );
-		dataSBUS.ch[4]  = SBUS_Transform( (int16_t)( (rxSBUS[6]  >> 4 | rxSBUS[7] << 4 ) 					 & 0x07FF) );
-		dataSBUS.ch[5]  = SBUS_Transform( (int16_t)( (rxSBUS[7]  >> 7 | rxSBUS[8] << 1 | rxSBUS[9] << 9 )   & 0x07FF) );
-		dataSBUS.ch[6]  = SBUS_Transform( (int16_t)( (rxSBUS[9]  >> 2 | rxSBUS[10] << 6 ) 				     & 0x07FF) );
-		dataSBUS.ch[7]  = SBUS_Transform( (int16_t)( (rxSBUS[10] >> 5 | rxSBUS[11] << 3 ) 				     & 0x07FF) );
-
-		dataSBUS.ch[8]  = SBUS_Transform( (int16_t)( (rxSBUS[12]	   | rxSBUS[13] << 8 ) 					   & 0x07FF) );
-		dataSBUS.ch[9]  = SBUS_Transform( (int16_t)( (rxSBUS[13] >> 3 | rxSBUS[14] << 5 ) 					   & 0x07FF) );
-		dataSBUS.ch[10] = SBUS_Transform( (int16_t)( (rxSBUS[14] >> 6 | rxSBUS[15] << 2  | rxSBUS[16] << 10 ) & 0x07FF) );
-		dataSBUS.ch[11] = SBUS_Transform( (int16_t)( (rxSBUS[16] >> 1 | rxSBUS[17] << 7 ) 					   & 0x07FF) );
-		dataSBUS.ch[12] = SBUS_Transform( (int16_t)( (rxSBUS[17] >> 4 | rxSBUS[18] << 4 ) 					   & 0x07FF) );
-		dataSBUS.ch[13] = SBUS_Transform( (int16_t)( (rxSBUS[18] >> 7 | rxSBUS[19] << 1 | rxSBUS[20] ) 	   & 0x07FF) );
-		dataSBUS.ch[14] = SBUS_Transform( (int16_t)( (rxSBUS[20] >> 2 | rxSBUS[21] << 6 )   				   & 0x07FF) );
-		dataSBUS.ch[15] = SBUS_Transform( (int16_t)( (rxSBUS[21] >> 5 | rxSBUS[22] << 3 ) 					   & 0x07FF) );
-
-		dataSBUS.ch17      = rxSBUS[23] & SBUS_CH17_MASK;
-		dataSBUS.ch17      = rxSBUS[23] & SBUS_CH18_MASK;
-		dataSBUS.failsafe  = rxSBUS[23] & SBUS_FAILSAFE_MASK;
-		dataSBUS.frameLost = rxSBUS[23] & SBUS_LOSTFRAME_MASK;
-
-		// Reset Flags
-		rxHeartbeatSBUS = false;
-		dataSBUS.inputLost = false;
-		prev = now;
-	}
-
-	// Check Failsafe
-	if (dataSBUS.failsafe)
-	{
-		dataSBUS.inputLost = true;
-	}
-	else if (!dataSBUS.inputLost && SBUS_TIMEOUT_FS <= (now - prev))
-	{
-		dataSBUS.inputLost = true;
-		memset(rxSBUS, 0, sizeof(rxSBUS));
-	}
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-SBUS_Data* SBUS_getDataPtr ( void )
-{
-	return &dataSBUS;
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PRIVATE FUNCTIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-uint16_t SBUS_Transform ( uint16_t r )
-{
-	uint32_t retVal = 0;
-
-	if (r == 0) {
-		retVal = 0;
-	} else if (r < (SBUS_MIN - SBUS_THRESHOLD)) {
-		retVal = 0;
-	} else if (r < SBUS_MIN) {
-		retVal = SBUS_MIN;
-	} else if (r <= SBUS_MAX) {
-		retVal = r;
-	} else if (r < (SBUS_MAX + SBUS_THRESHOLD))	{
-		retVal = SBUS_MAX;
-	} else {
-		retVal = 0;
-	}
-
-	if (retVal)
-	{
-		retVal *= SBUS_MAP_RANGE;
-		retVal /= SBUS_RANGE;
-		retVal += SBUS_MAP_MIN;
-		retVal -= (SBUS_MIN * SBUS_MAP_RANGE / SBUS_RANGE);
-	}
-
-	return (uint16_t)retVal;
-}
-
-
-/*
- * TEXT
- *
- * INPUTS:
- * OUTPUTS:
- */
-void SBUS_HandleUART ( void )
-{
-	uint32_t now = CORE_GetTick();
-	static uint32_t timeout = 0;
-	static bool detH = false;
-
-	// Check for Start of transmission (Header)
-	if ( !detH )
-	{
-		// Process All Available Bytes in Buffer Until Header Detected
-		while (UART_ReadCount(SBUS_UART) >= SBUS_HEADER_LEN)
-		{
-			// Read in Next Byte
-			UART_Read(SBUS_UART, &rxSBUS[SBUS_HEADER_INDEX], SBUS_HEADER_LEN);
-			// Check if the Byte is the Message Header1
-			if ( rxSBUS[SBUS_HEADER_INDEX] == SBUS_HEADER )
-			{
-				detH = true;
-				timeout = now + SBUS_TIMEOUT_IP;
-				break;
-			}
-		}
-	}
-
-	// Header Detected, Read Remaining Transmission
-	if ( detH )
-	{
-		// Only Proceed When Full Message is Ready
-		if ( UART_ReadCount(SBUS_UART) >= (SBUS_PAYLOAD_LEN - SBUS_HEADER_LEN) )
-		{
-			// Read in Remaining Message
-			UART_Read(SBUS_UART, &rxSBUS[SBUS_DATA_INDEX], (SBUS_PAYLOAD_LEN - SBUS_HEADER_LEN));
-			//
-			if ( rxSBUS[SBUS_FOOTER_INDEX] == SBUS_FOOTER ) {
-				rxHeartbeatSBUS = true;
-			}
-			// Reset the detected flag
-			detH = false;
-		}
-
-		// Check for a timeout
-		if ( now > timeout)
-		{
-			detH = false;
-		}
-	}
-}
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EVENT HANDLERS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* INTERRUPT ROUTINES									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#endif
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "SBUS.h"
+#include "Radio.h"
+
+#if defined(RADIO_USE_SBUS)
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#define EMPTY				0
+
+#define SBUS_HEADER_INDEX	0
+#define SBUS_DATA_INDEX		(SBUS_HEADER_INDEX + SBUS_HEADER_LEN)
+#define SBUS_AUX_INDEX		(SBUS_DATA_INDEX + SBUS_DATA_LEN)
+#define SBUS_FOOTER_INDEX	(SBUS_AUX_INDEX + SBUS_AUX_LEN)
+
+#define SBUS_HEADER			0x0F
+#define SBUS_FOOTER			0x00
+#define SBUS_CH17_MASK		0x01
+#define SBUS_CH18_MASK		0x02
+#define SBUS_LOSTFRAME_MASK	0x04
+#define SBUS_FAILSAFE_MASK	0x08
+
+#define SBUS_THRESHOLD		500
+#define SBUS_DROPPED_FRAMES	3
+#define SBUS_TIMEOUT_FS		TIMEBASE_MS(SBUS_PERIOD * SBUS_DROPPED_FRAMES)
+#define SBUS_TIMEOUT_GAP	8		// Silence mid frame that aborts it, in characters
+#define SBUS_TIMEOUT_SLACK	500		// Added to a frame's time on the wire before it is abandoned (us)
+#define SBUS_CHAR_BITS		12		// 8E2
+
+#define SBUS_LQ_FILTER		8		// Link quality averaging length (frames)
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+static uint16_t	SBUS_Transform 	( uint16_t );
+#ifdef RADIO_PARSE_IN_IRQ
+static void 	SBUS_Parse		( SBUS_t *, uint8_t );
+#else
+#ifndef RADIO_RX_IN_IRQ
+static void 	SBUS_HandleUART	( SBUS_t * );
+#endif
+static void 	SBUS_ParseRing	( SBUS_t * );
+#endif
+static void 	SBUS_Publish	( SBUS_t *, const uint8_t * );
+static void 	SBUS_Commit		( SBUS_t *, uint8_t, uint16_t );
+#ifdef RADIO_LAZY_DECODE
+static uint16_t	SBUS_Unpack		( const uint8_t *, uint8_t );
+static void 	SBUS_Flush		( SBUS_t * );
+#endif
+
+static bool 	SBUS_opsInit			( void *, uint32_t, bool );
+static void 	SBUS_opsDeinit			( void * );
+static bool 	SBUS_opsDetect			( void * );
+static void 	SBUS_opsUpdate			( void * );
+static uint16_t*	SBUS_opsGetData			( void * );
+#ifdef RADIO_LAZY_DECODE
+static void 	SBUS_opsSubscribe		( void *, uint32_t );
+#endif
+#ifdef RADIO_USE_HIRES
+static int16_t*	SBUS_opsGetNormalised	( void * );
+static uint16_t*	SBUS_opsGetRaw			( void * );
+#endif
+static uint32_t	SBUS_opsGetInputLost	( void * );
+static uint32_t	SBUS_opsGetFrameCount	( void * );
+static uint32_t	SBUS_opsGetFrameTime	( void * );
+static uint8_t	SBUS_opsGetLinkQuality	( void * );
+static void 	SBUS_opsOnFrame			( void *, void (*)(void) );
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+static void 	SBUS_opsRxByte			( void *, uint8_t );
+#endif
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* Dispatch table for Radio.c, which keeps an SBUS_t per input */
+const RADIO_ops_t SBUS_ops = {
+	.chCount		= SBUS_CH_NUM,
+	.init			= SBUS_opsInit,
+	.deinit			= SBUS_opsDeinit,
+	.detect			= SBUS_opsDetect,
+	.update			= SBUS_opsUpdate,
+	.getData		= SBUS_opsGetData,
+#ifdef RADIO_LAZY_DECODE
+	.subscribe		= SBUS_opsSubscribe,
+#endif
+#ifdef RADIO_USE_HIRES
+	.getNormalised	= SBUS_opsGetNormalised,
+	.getRaw			= SBUS_opsGetRaw,
+#endif
+	.getInputLost	= SBUS_opsGetInputLost,
+	.getFrameCount	= SBUS_opsGetFrameCount,
+	.getLinkQuality	= SBUS_opsGetLinkQuality,
+	.getFrameTime	= SBUS_opsGetFrameTime,
+	.onFrame		= SBUS_opsOnFrame,
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+	.rxByte			= SBUS_opsRxByte,
+#endif
+};
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * Binds the receiver to a UART and starts it. Clears any callback, so SBUS_OnFrame() goes after this.
+ * Any number of receivers can run, each with its own SBUS_t and UART.
+ *
+ * INPUTS: baud - SBUS_BAUD or SBUS_BAUD_FAST, inverted - true for standard SBUS (idles low)
+ * OUTPUTS:
+ */
+void SBUS_Init ( SBUS_t * sbus, UART_t * uart, uint32_t baud, bool inverted )
+{
+	memset(sbus, 0, sizeof(*sbus));
+	sbus->uart = uart;
+#ifdef RADIO_PARSE_IN_IRQ
+	sbus->rxIndex = SBUS_HEADER_INDEX;
+#else
+	RING_Init(&sbus->ring, sbus->ringBuffer, sizeof(sbus->ringBuffer));
+#endif
+	sbus->fill = 1;
+	sbus->charUs = TIMEBASE_CharUs(baud, SBUS_CHAR_BITS);
+	sbus->data.inputLost = true;
+	sbus->baud = baud;
+	sbus->linkQuality = 100 * SBUS_LQ_FILTER;
+	TIMEBASE_RateInit(&sbus->rate, SBUS_TIMEOUT_FS);
+#ifdef RADIO_LAZY_DECODE
+	sbus->subscribed = RADIO_CH_MASK(SBUS_CH_NUM);
+#endif
+
+	UART_Init(uart, baud, inverted ? UART_Mode_Inverted : UART_Mode_Default);
+	UART_ReadFlush(uart);
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+void SBUS_Deinit ( SBUS_t * sbus )
+{
+	UART_Deinit(sbus->uart);
+}
+
+
+/*
+ * Non-blocking. Call after SBUS_Update() during detection.
+ * Baud rate selection (SBUS_BAUD / SBUS_BAUD_FAST) is handled by the caller.
+ *
+ * INPUTS:
+ * OUTPUTS: True once valid frames are being received
+ */
+bool SBUS_Detect ( SBUS_t * sbus )
+{
+	return !sbus->data.inputLost;
+}
+
+
+/*
+ * Parses buffered bytes, then takes the last complete frame.
+ * With RADIO_PARSE_IN_IRQ the bytes were already parsed by SBUS_RX_IRQ().
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+void SBUS_Update ( SBUS_t * sbus )
+{
+#ifndef RADIO_PARSE_IN_IRQ
+	// Update Rx Data
+#ifndef RADIO_RX_IN_IRQ
+	SBUS_HandleUART(sbus);
+#endif
+	SBUS_ParseRing(sbus);
+#endif
+
+	// Init Loop Variables
+	uint32_t seq = sbus->rxSeq;
+
+	// Check for New Input Data
+	if (seq != sbus->frameCount)
+	{
+		// Copy the published frame. If the parser publishes again mid copy the
+		// buffer may be reused, so repeat with the newer frame.
+		uint8_t flags;
+		do {
+			seq = sbus->rxSeq;
+			uint8_t ready = sbus->rxReady;
+#ifdef RADIO_LAZY_DECODE
+			// Only the packed bytes, channels are unpacked when first read
+			for (uint8_t i = 0; i < SBUS_DATA_LEN; i++)
+			{
+				sbus->packed[i] = sbus->rxPacked[ready][i];
+			}
+#else
+			for (uint8_t i = 0; i < SBUS_CH_NUM; i++)
+			{
+				SBUS_Commit(sbus, i, sbus->rxCh[ready][i]);
+			}
+#endif
+			flags = sbus->rxFlags[ready];
+			sbus->frameTime = sbus->rxTime[ready];
+		} while (seq != sbus->rxSeq);
+#ifdef RADIO_LAZY_DECODE
+		sbus->dirty = sbus->subscribed;
+#endif
+
+		sbus->data.ch17      = flags & SBUS_CH17_MASK;
+		sbus->data.ch18      = flags & SBUS_CH18_MASK;
+		sbus->data.failsafe  = flags & SBUS_FAILSAFE_MASK;
+		sbus->data.frameLost = flags & SBUS_LOSTFRAME_MASK;
+
+		// Average the receiver's lost frame flag into a link quality
+		sbus->linkQuality -= sbus->linkQuality / SBUS_LQ_FILTER;
+		sbus->linkQuality += sbus->data.frameLost ? 0 : 100;
+
+		TIMEBASE_RateFrame(&sbus->rate, sbus->frameTime, seq - sbus->frameCount);
+
+		// Reset Flags
+		sbus->data.inputLost = false;
+		sbus->frameCount = seq;
+
+#ifndef RADIO_PARSE_IN_IRQ
+		if (sbus->onFrame != NULL) { sbus->onFrame(); }
+#endif
+	}
+
+	// Check Failsafe
+	if (sbus->data.failsafe)
+	{
+		sbus->data.inputLost = true;
+	}
+	else if (!sbus->data.inputLost && TIMEBASE_Elapsed(sbus->frameTime, TIMEBASE_RateTimeout(&sbus->rate)))
+	{
+		sbus->data.inputLost = true;
+	}
+}
+
+
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+/*
+ * Call from the receive interrupt of the receiver's UART with each byte received.
+ * RADIO_RX_IN_IRQ queues it for SBUS_Update(), dropped if the ring is full.
+ * RADIO_PARSE_IN_IRQ parses it straight away at a bounded cost per byte,
+ * the last byte of a frame adds the channel unpack.
+ *
+ * INPUTS: byte - received byte
+ * OUTPUTS:
+ */
+void SBUS_RX_IRQ ( SBUS_t * sbus, uint8_t byte )
+{
+#ifdef RADIO_PARSE_IN_IRQ
+	SBUS_Parse(sbus, byte);
+#else
+	RING_Put(&sbus->ring, byte);
+#endif
+}
+#endif
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+SBUS_Data* SBUS_getDataPtr ( SBUS_t * sbus )
+{
+#ifdef RADIO_LAZY_DECODE
+	SBUS_Flush(sbus);
+#endif
+	return &sbus->data;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+uint16_t* SBUS_getData ( SBUS_t * sbus )
+{
+#ifdef RADIO_LAZY_DECODE
+	SBUS_Flush(sbus);
+#endif
+	return sbus->data.ch;
+}
+
+
+/*
+ * One channel of the last frame. With RADIO_LAZY_DECODE only this channel is unpacked.
+ *
+ * INPUTS: c - channel index
+ * OUTPUTS: Channel (us), 0 if out of range or without data
+ */
+uint16_t SBUS_getChannel ( SBUS_t * sbus, uint8_t c )
+{
+	if (c >= SBUS_CH_NUM) { return 0; }
+
+#ifdef RADIO_LAZY_DECODE
+	if (sbus->dirty & (1UL << c))
+	{
+		sbus->dirty &= ~(1UL << c);
+		SBUS_Commit(sbus, c, SBUS_Unpack(sbus->packed, c));
+	}
+#endif
+	return sbus->data.ch[c];
+}
+
+
+#ifdef RADIO_LAZY_DECODE
+/*
+ * Channels to unpack from each frame. The others keep their last value.
+ * Takes effect from the current frame.
+ *
+ * INPUTS: mask - bit per channel
+ * OUTPUTS:
+ */
+void SBUS_Subscribe ( SBUS_t * sbus, uint32_t mask )
+{
+	sbus->subscribed = mask & RADIO_CH_MASK(SBUS_CH_NUM);
+	sbus->dirty &= sbus->subscribed;
+}
+#endif
+
+
+#ifdef RADIO_USE_HIRES
+/*
+ * Channels as Q15, +-32767 for SBUS_MIN to SBUS_MAX, without rounding to microseconds
+ *
+ * INPUTS:
+ * OUTPUTS: Q15 per channel, 0 where the channel has no data
+ */
+int16_t* SBUS_getNormalised ( SBUS_t * sbus )
+{
+#ifdef RADIO_LAZY_DECODE
+	SBUS_Flush(sbus);
+#endif
+	return sbus->norm;
+}
+
+
+/*
+ * Channel values as received, before bounding and scaling
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+uint16_t* SBUS_getRaw ( SBUS_t * sbus )
+{
+#ifdef RADIO_LAZY_DECODE
+	SBUS_Flush(sbus);
+#endif
+	return sbus->raw;
+}
+#endif
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+uint32_t SBUS_getInputLost ( SBUS_t * sbus )
+{
+	return sbus->data.inputLost ? RADIO_CH_MASK(SBUS_CH_NUM) : 0;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS: Number of valid frames decoded. Wraps.
+ */
+uint32_t SBUS_getFrameCount ( SBUS_t * sbus )
+{
+	return sbus->frameCount;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS: US_Read() timestamp of the last frame, taken when its last byte was parsed
+ */
+uint32_t SBUS_getFrameTime ( SBUS_t * sbus )
+{
+	return sbus->frameTime;
+}
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS: Percentage of recent frames not flagged lost by the receiver
+ */
+uint8_t SBUS_getLinkQuality ( SBUS_t * sbus )
+{
+	if ( sbus->data.inputLost ) { return 0; }
+
+	return (uint8_t)(sbus->linkQuality / SBUS_LQ_FILTER);
+}
+
+
+/*
+ * Registers a callback fired from SBUS_Update() as soon as a valid frame is committed,
+ * or from SBUS_RX_IRQ() with RADIO_PARSE_IN_IRQ
+ *
+ * INPUTS: callback - NULL to remove
+ * OUTPUTS:
+ */
+void SBUS_OnFrame ( SBUS_t * sbus, void (*callback)(void) )
+{
+	sbus->onFrame = callback;
+}
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/*
+ * TEXT
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+static uint16_t SBUS_Transform ( uint16_t r )
+{
+	uint32_t retVal = 0;
+
+	if (r == 0) {
+		retVal = 0;
+	} else if (r < (SBUS_MIN - SBUS_THRESHOLD)) {
+		retVal = 0;
+	} else if (r < SBUS_MIN) {
+		retVal = SBUS_MIN;
+	} else if (r <= SBUS_MAX) {
+		retVal = r;
+	} else if (r < (SBUS_MAX + SBUS_THRESHOLD))	{
+		retVal = SBUS_MAX;
+	} else {
+		retVal = 0;
+	}
+
+	if (retVal)
+	{
+		retVal *= SBUS_MAP_RANGE;
+		retVal /= SBUS_RANGE;
+		retVal += SBUS_MAP_MIN;
+		retVal -= (SBUS_MIN * SBUS_MAP_RANGE / SBUS_RANGE);
+	}
+
+	return (uint16_t)retVal;
+}
+
+
+#ifdef RADIO_PARSE_IN_IRQ
+/*
+ * Advances the frame state machine by one byte
+ *
+ * INPUTS: byte - received byte
+ * OUTPUTS:
+ */
+static void SBUS_Parse ( SBUS_t * sbus, uint8_t byte )
+{
+	// Bytes arrive as they are received, so a gap this long means the frame was cut short
+	uint32_t now = TIMEBASE_Now();
+	if (sbus->rxIndex != SBUS_HEADER_INDEX && (now - sbus->rxStart) >= sbus->charUs * SBUS_TIMEOUT_GAP)
+	{
+		sbus->rxIndex = SBUS_HEADER_INDEX;
+	}
+	sbus->rxStart = now;
+
+	// Check for Start of transmission (Header)
+	if (sbus->rxIndex == SBUS_HEADER_INDEX)
+	{
+		if (byte == SBUS_HEADER)
+		{
+			sbus->rx[SBUS_HEADER_INDEX] = byte;
+			sbus->rxIndex = SBUS_DATA_INDEX;
+		}
+		return;
+	}
+
+	// Header Detected, Read Remaining Transmission
+	sbus->rx[sbus->rxIndex++] = byte;
+	if (sbus->rxIndex >= SBUS_PAYLOAD_LEN)
+	{
+		if (sbus->rx[SBUS_FOOTER_INDEX] == SBUS_FOOTER) {
+			SBUS_Publish(sbus, sbus->rx);
+		}
+		// Reset the detected flag
+		sbus->rxIndex = SBUS_HEADER_INDEX;
+	}
+}
+#else
+#ifndef RADIO_RX_IN_IRQ
+/*
+ * Moves everything the UART driver has buffered into the ring,
+ * one block read per contiguous span
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+static void SBUS_HandleUART ( SBUS_t * sbus )
+{
+	uint32_t count = UART_ReadCount(sbus->uart);
+
+	while (count > 0)
+	{
+		uint8_t * span;
+		uint32_t n = RING_WriteSpan(&sbus->ring, &span);
+		if (n == 0) { break; }
+		if (n > count) { n = count; }
+
+		UART_Read(sbus->uart, span, n);
+		RING_Write(&sbus->ring, n);
+		count -= n;
+	}
+}
+#endif
+
+
+/*
+ * Validates frames in place at the front of the ring. A frame is consumed whole
+ * once its header and footer check out, otherwise the ring moves on one byte.
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+static void SBUS_ParseRing ( SBUS_t * sbus )
+{
+	uint32_t count;
+
+	while ((count = RING_Count(&sbus->ring)) >= SBUS_HEADER_LEN)
+	{
+		// Check for Start of transmission (Header)
+		if (RING_Peek(&sbus->ring, SBUS_HEADER_INDEX) != SBUS_HEADER)
+		{
+			RING_Skip(&sbus->ring, 1);
+			sbus->rxPending = false;
+			continue;
+		}
+
+		// Header Detected, Wait for Remaining Transmission
+		if (count < SBUS_PAYLOAD_LEN)
+		{
+			if (!sbus->rxPending) {
+				sbus->rxPending = true;
+				sbus->rxStart = TIMEBASE_Now();
+			} else if (TIMEBASE_Elapsed(sbus->rxStart, SBUS_PAYLOAD_LEN * sbus->charUs + SBUS_TIMEOUT_SLACK)) {
+				RING_Skip(&sbus->ring, 1);
+				sbus->rxPending = false;
+				continue;
+			}
+			break;
+		}
+		sbus->rxPending = false;
+
+		if (RING_Peek(&sbus->ring, SBUS_FOOTER_INDEX) != SBUS_FOOTER)
+		{
+			RING_Skip(&sbus->ring, 1);
+			continue;
+		}
+
+		SBUS_Publish(sbus, RING_Linearise(&sbus->ring, sbus->rx, SBUS_PAYLOAD_LEN));
+		RING_Skip(&sbus->ring, SBUS_PAYLOAD_LEN);
+	}
+}
+#endif
+
+
+/*
+ * Unpacks the 16x 11-bit channels of a frame into the fill buffer and publishes it.
+ * With RADIO_LAZY_DECODE the packed bytes are published as they are.
+ *
+ * INPUTS: frame - complete, validated frame
+ * OUTPUTS:
+ */
+static void SBUS_Publish ( SBUS_t * sbus, const uint8_t * frame )
+{
+#ifdef RADIO_LAZY_DECODE
+	for (uint8_t i = 0; i < SBUS_DATA_LEN; i++)
+	{
+		sbus->rxPacked[sbus->fill][i] = frame[SBUS_DATA_INDEX + i];
+	}
+#else
+	volatile uint16_t * ch = sbus->rxCh[sbus->fill];
+
+	ch[0]  = (frame[1]       | frame[2]  << 8 )                    & 0x07FF;
+	ch[1]  = (frame[2]  >> 3 | frame[3]  << 5 )                    & 0x07FF;
+	ch[2]  = (frame[3]  >> 6 | frame[4]  << 2 | frame[5]  << 10 )  & 0x07FF;
+	ch[3]  = (frame[5]  >> 1 | frame[6]  << 7 )                    & 0x07FF;
+	ch[4]  = (frame[6]  >> 4 | frame[7]  << 4 )                    & 0x07FF;
+	ch[5]  = (frame[7]  >> 7 | frame[8]  << 1 | frame[9]  << 9 )   & 0x07FF;
+	ch[6]  = (frame[9]  >> 2 | frame[10] << 6 )                    & 0x07FF;
+	ch[7]  = (frame[10] >> 5 | frame[11] << 3 )                    & 0x07FF;
+
+	ch[8]  = (frame[12]      | frame[13] << 8 )                    & 0x07FF;
+	ch[9]  = (frame[13] >> 3 | frame[14] << 5 )                    & 0x07FF;
+	ch[10] = (frame[14] >> 6 | frame[15] << 2 | frame[16] << 10 )  & 0x07FF;
+	ch[11] = (frame[16] >> 1 | frame[17] << 7 )                    & 0x07FF;
+	ch[12] = (frame[17] >> 4 | frame[18] << 4 )                    & 0x07FF;
+	ch[13] = (frame[18] >> 7 | frame[19] << 1 | frame[20] << 9 )   & 0x07FF;
+	ch[14] = (frame[20] >> 2 | frame[21] << 6 )                    & 0x07FF;
+	ch[15] = (frame[21] >> 5 | frame[22] << 3 )                    & 0x07FF;
+#endif
+
+	sbus->rxFlags[sbus->fill] = frame[SBUS_AUX_INDEX];
+
+	// Publish the frame and fill the other buffer next
+	sbus->rxTime[sbus->fill] = US_Read();
+	sbus->rxReady = sbus->fill;
+	sbus->fill ^= 1;
+	sbus->rxSeq++;
+
+#ifdef RADIO_PARSE_IN_IRQ
+	if (sbus->onFrame != NULL) { sbus->onFrame(); }
+#endif
+}
+
+
+/*
+ * Stores channel c of the last frame from its raw value
+ *
+ * INPUTS: c - channel index, r - 11 bit channel value
+ * OUTPUTS:
+ */
+static void SBUS_Commit ( SBUS_t * sbus, uint8_t c, uint16_t r )
+{
+	sbus->data.ch[c] = SBUS_Transform(r);
+#ifdef RADIO_USE_HIRES
+	sbus->raw[c] = r;
+	sbus->norm[c] = sbus->data.ch[c] ? RADIO_Q15(RADIO_MAX(RADIO_MIN(r, SBUS_MAX), SBUS_MIN), SBUS_MIN, SBUS_MAX) : 0;
+#endif
+}
+
+
+#ifdef RADIO_LAZY_DECODE
+/*
+ * Extracts one channel from the packed channel bytes, 11 bits LSB first
+ *
+ * INPUTS: packed - SBUS_DATA_LEN bytes, c - channel index
+ * OUTPUTS: 11 bit channel value
+ */
+static uint16_t SBUS_Unpack ( const uint8_t * packed, uint8_t c )
+{
+	uint32_t bit = c * 11;
+	const uint8_t * b = &packed[bit >> 3];
+	uint32_t r = (b[0] | b[1] << 8) >> (bit & 7);
+
+	// Slices starting past bit 5 reach into a third byte
+	if ((bit & 7) > 5)
+	{
+		r |= (uint32_t)b[2] << (16 - (bit & 7));
+	}
+	return r & 0x07FF;
+}
+
+
+/*
+ * Unpacks every subscribed channel not yet read from the last frame
+ *
+ * INPUTS:
+ * OUTPUTS:
+ */
+static void SBUS_Flush ( SBUS_t * sbus )
+{
+	uint32_t dirty = sbus->dirty;
+	sbus->dirty = 0;
+	for (uint8_t c = 0; dirty; c++, dirty >>= 1)
+	{
+		if (dirty & 1) { SBUS_Commit(sbus, c, SBUS_Unpack(sbus->packed, c)); }
+	}
+}
+#endif
+
+
+/*
+ * SBUS_ops entries
+ * ctx is the SBUS_t of the Radio.c input, which is bound to SBUS_UART
+ *
+ * INPUTS: ctx - SBUS_t
+ * OUTPUTS:
+ */
+static bool SBUS_opsInit ( void * ctx, uint32_t baud, bool inverted )
+{
+	SBUS_Init(ctx, SBUS_UART, baud, inverted);
+	return true;
+}
+
+static void SBUS_opsDeinit ( void * ctx )
+{
+	SBUS_Deinit(ctx);
+}
+
+static bool SBUS_opsDetect ( void * ctx )
+{
+	return SBUS_Detect(ctx);
+}
+
+static void SBUS_opsUpdate ( void * ctx )
+{
+	SBUS_Update(ctx);
+}
+
+static uint16_t* SBUS_opsGetData ( void * ctx )
+{
+	return SBUS_getData(ctx);
+}
+
+#ifdef RADIO_LAZY_DECODE
+static void SBUS_opsSubscribe ( void * ctx, uint32_t mask )
+{
+	SBUS_Subscribe(ctx, mask);
+}
+#endif
+
+#ifdef RADIO_USE_HIRES
+static int16_t* SBUS_opsGetNormalised ( void * ctx )
+{
+	return SBUS_getNormalised(ctx);
+}
+
+static uint16_t* SBUS_opsGetRaw ( void * ctx )
+{
+	return SBUS_getRaw(ctx);
+}
+#endif
+
+static uint32_t SBUS_opsGetInputLost ( void * ctx )
+{
+	return SBUS_getInputLost(ctx);
+}
+
+static uint32_t SBUS_opsGetFrameCount ( void * ctx )
+{
+	return SBUS_getFrameCount(ctx);
+}
+
+static uint32_t SBUS_opsGetFrameTime ( void * ctx )
+{
+	return SBUS_getFrameTime(ctx);
+}
+
+static uint8_t SBUS_opsGetLinkQuality ( void * ctx )
+{
+	return SBUS_getLinkQuality(ctx);
+}
+
+static void SBUS_opsOnFrame ( void * ctx, void (*callback)(void) )
+{
+	SBUS_OnFrame(ctx, callback);
+}
+
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+static void SBUS_opsRxByte ( void * ctx, uint8_t byte )
+{
+	SBUS_RX_IRQ(ctx, byte);
+}
+#endif
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
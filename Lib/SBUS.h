@@ -1,75 +1,154 @@
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#ifndef SBUS_H
-#define SBUS_H
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-#include "STM32X.h"
-
-#include "Core.h"
-#include "UART.h"
-#include "GPIO.h"
-#include "US.h"
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC DEFINITIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-#define SBUS_CH_NUM				16		// x16 standard channels
-
-#define SBUS_BAUD				100000
-#define SBUS_BAUD_FAST			200000
-
-#define SBUS_PERIOD_ANALOGUE	14
-#define SBUS_PERIOD_FAST		7
-#define	SBUS_PERIOD				SBUS_PERIOD_ANALOGUE
-
-#define SBUS_MIN				172
-#define SBUS_CENTER				991
-#define SBUS_MAX				1811
-#define SBUS_RANGE				(SBUS_MAX - SBUS_MIN)
-
-#define SBUS_MAP_MIN			1000
-#define SBUS_MAP_MAX			2000
-#define SBUS_MAP_RANGE			(SBUS_MAP_MAX - SBUS_MAP_MIN)
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC TYPES      									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-typedef struct {
-	bool inputLost;
-	bool frameLost;
-	bool failsafe;
-	bool ch17;
-	bool ch18;
-	uint32_t ch[SBUS_CH_NUM];
-} SBUS_Data;
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* PUBLIC FUNCTIONS										*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-void 		SBUS_Init 		( uint32_t );
-void 		SBUS_Deinit 	( void );
-bool 		SBUS_Detect 	( void );
-void 		SBUS_Update 	( void );
-
-SBUS_Data*	SBUS_getDataPtr	( void );
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-/* EXTERN DECLARATIONS									*/
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-
-
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
-#endif /* SBUS_H */
-/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef SBUS_H
+#define SBUS_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#include "STM32X.h"
+
+#include "Core.h"
+#include "UART.h"
+#include "GPIO.h"
+#include "US.h"
+#include "Ring.h"
+#include "Timebase.h"
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+#define SBUS_CH_NUM				16		// x16 standard channels
+
+#define SBUS_BAUD				100000
+#define SBUS_BAUD_FAST			200000
+
+#define SBUS_PERIOD_ANALOGUE	14
+#define SBUS_PERIOD_FAST		7
+#define	SBUS_PERIOD				SBUS_PERIOD_ANALOGUE
+
+#define SBUS_DETECT_MS			(SBUS_PERIOD * 6)	// Listen window per baud rate during detection
+
+#define SBUS_MIN				172
+#define SBUS_CENTER				991
+#define SBUS_MAX				1811
+#define SBUS_RANGE				(SBUS_MAX - SBUS_MIN)
+
+#define SBUS_MAP_MIN			1000
+#define SBUS_MAP_MAX			2000
+#define SBUS_MAP_RANGE			(SBUS_MAP_MAX - SBUS_MAP_MIN)
+
+#define SBUS_HEADER_LEN			1
+#define SBUS_DATA_LEN			22
+#define SBUS_AUX_LEN			1
+#define SBUS_FOOTER_LEN			1
+#define SBUS_PAYLOAD_LEN		(SBUS_HEADER_LEN + SBUS_DATA_LEN + SBUS_AUX_LEN + SBUS_FOOTER_LEN)
+
+#define SBUS_RING_SIZE			64		// Serial ring, power of two and at least two frames
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+typedef struct {
+	bool inputLost;
+	bool frameLost;
+	bool failsafe;
+	bool ch17;
+	bool ch18;
+	uint16_t ch[SBUS_CH_NUM];
+} SBUS_Data;
+
+/*
+ * One SBUS receiver, bound to a UART by SBUS_Init().
+ * Only the SBUS_* functions touch it.
+ */
+typedef struct {
+	UART_t * uart;
+	uint32_t baud;
+	uint32_t charUs;						// One character at the configured baud
+	uint32_t rxStart;						// Header seen (ring) or last byte (IRQ)
+	uint8_t rx[SBUS_PAYLOAD_LEN];
+#ifdef RADIO_PARSE_IN_IRQ
+	// Parser state - owned by SBUS_Parse(), which runs in the RX interrupt
+	uint8_t rxIndex;						// Next byte of rx, header while searching
+#else
+	// Bytes waiting to be parsed, from SBUS_RX_IRQ() or drained from the UART driver
+	uint8_t ringBuffer[SBUS_RING_SIZE];
+	RING_t ring;
+	bool rxPending;							// Partial frame at the front of the ring
+#endif
+
+	// Double buffer - the parser fills one while the other holds the last complete frame
+#ifdef RADIO_LAZY_DECODE
+	volatile uint8_t rxPacked[2][SBUS_DATA_LEN];	// Channel bytes as received, unpacked on first read
+#else
+	volatile uint16_t rxCh[2][SBUS_CH_NUM];
+#endif
+	volatile uint8_t rxFlags[2];			// Aux byte of each buffer's frame
+	volatile uint8_t rxReady;				// Buffer holding the last complete frame
+	volatile uint32_t rxSeq;				// Incremented by the parser for each complete frame
+	volatile uint32_t rxTime[2];			// US_Read() at the last byte of each buffer's frame
+	uint8_t fill;							// Buffer being filled, never rxReady
+
+	SBUS_Data data;
+#ifdef RADIO_LAZY_DECODE
+	uint8_t packed[SBUS_DATA_LEN];			// Channel bytes of the last committed frame
+	uint32_t dirty;							// Channels of packed not yet unpacked into data.ch
+	uint32_t subscribed;					// Channels unpacked at all, all by default
+#endif
+#ifdef RADIO_USE_HIRES
+	uint16_t raw[SBUS_CH_NUM];				// Channel values as received
+	int16_t norm[SBUS_CH_NUM];				// Q15 of the raw values, 0 where data.ch is 0
+#endif
+	uint32_t frameCount;
+	uint32_t frameTime;
+	TIMEBASE_rate_t rate;					// Frame rate, sets the failsafe timeout
+	uint32_t linkQuality;					// Percent, scaled by SBUS_LQ_FILTER
+	void (*onFrame)(void);
+} SBUS_t;
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+void 		SBUS_Init 			( SBUS_t *, UART_t *, uint32_t, bool );
+void 		SBUS_Deinit 		( SBUS_t * );
+bool 		SBUS_Detect 		( SBUS_t * );
+void 		SBUS_Update 		( SBUS_t * );
+
+uint16_t*	SBUS_getData		( SBUS_t * );
+uint16_t	SBUS_getChannel		( SBUS_t *, uint8_t );
+#ifdef RADIO_LAZY_DECODE
+void 		SBUS_Subscribe		( SBUS_t *, uint32_t );
+#endif
+#ifdef RADIO_USE_HIRES
+int16_t*	SBUS_getNormalised	( SBUS_t * );
+uint16_t*	SBUS_getRaw			( SBUS_t * );
+#endif
+uint32_t	SBUS_getInputLost	( SBUS_t * );
+uint32_t	SBUS_getFrameCount	( SBUS_t * );
+uint32_t	SBUS_getFrameTime	( SBUS_t * );
+uint8_t		SBUS_getLinkQuality	( SBUS_t * );
+void 		SBUS_OnFrame		( SBUS_t *, void (*)(void) );
+SBUS_Data*	SBUS_getDataPtr		( SBUS_t * );
+
+#if defined(RADIO_PARSE_IN_IRQ) || defined(RADIO_RX_IN_IRQ)
+void 		SBUS_RX_IRQ			( SBUS_t *, uint8_t );
+#endif
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* SBUS_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,167 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Smooth.h"
+#include "Radio.h"
+#include "Timebase.h"
+
+#ifdef RADIO_USE_SMOOTHING
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#define SMOOTH_RECIP_SHIFT		24		// 1/window, scaled so slopes come out Q16 after >> 8
+#define SMOOTH_FRAMES_MAX		0xFF
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static uint16_t	SMOOTH_At		( const SMOOTH_t *, uint8_t, uint32_t );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * SMOOTH_Init
+ *  -
+ */
+void SMOOTH_Init ( SMOOTH_t * sm )
+{
+	memset( sm, 0, sizeof(*sm) );
+}
+
+/*
+ * SMOOTH_Frame
+ *  - Starts the ramps to a new frame of channels (microseconds, 0 for no data).
+ *  - frameTime is its TIMEBASE_Now() timestamp, id identifies the source (input and protocol).
+ *  - One division per frame, the rest is a multiply per channel.
+ */
+void SMOOTH_Frame ( SMOOTH_t * sm, const uint16_t * ch, uint8_t count, uint32_t frameTime, uint8_t id )
+{
+	count = RADIO_MIN( count, SMOOTH_CH_NUM );
+
+	uint32_t since = frameTime - sm->frameTime;
+	bool restart = ( sm->count == 0 || sm->count != count || sm->id != id );
+
+	sm->frameTime	= frameTime;
+	sm->count		= count;
+	sm->id			= id;
+
+	if ( restart || since > SMOOTH_GAP_US ) {
+		if ( restart ) {
+			sm->frames	 = 0;
+			sm->interval = 0;
+		}
+		sm->window = 0;
+		for ( uint8_t c = 0; c < count; c++ ) {
+			sm->base[c] = sm->target[c] = sm->out[c] = ch[c];
+			sm->rate[c] = sm->deriv[c] = 0;
+		}
+		return;
+	}
+
+	const uint32_t elapsed = since;
+
+	// Running average of the interval. A missed frame counts as at most two intervals
+	if ( sm->frames == 0 ) {
+		sm->interval = since << 4;
+	} else {
+		since = RADIO_MIN( since, (sm->interval >> 4) * 2 );
+		int32_t error = (int32_t)(since << 4) - (int32_t)sm->interval;
+		sm->interval += error >> SMOOTH_AVG_SHIFT;
+	}
+	if ( sm->frames < SMOOTH_FRAMES_MAX ) { sm->frames++; }
+
+	uint32_t window = RADIO_MAX( sm->interval >> 4, SMOOTH_WINDOW_MIN_US );
+	int32_t recip = (1 << SMOOTH_RECIP_SHIFT) / window;
+
+	// Each ramp starts from where the previous one has got to
+	for ( uint8_t c = 0; c < count; c++ )
+	{
+		uint16_t from = SMOOTH_At( sm, c, elapsed );
+
+		sm->base[c]		= from;
+		sm->target[c]	= ch[c];
+		sm->out[c]		= from;
+
+		if ( from == 0 || ch[c] == 0 ) {
+			sm->base[c] = ch[c];
+			sm->rate[c] = sm->deriv[c] = 0;
+			continue;
+		}
+
+		sm->rate[c]  = ((int32_t)ch[c] - from) * recip >> (SMOOTH_RECIP_SHIFT - 16);
+		sm->deriv[c] = (sm->rate[c] * (TIMEBASE_US_PER_S >> 6)) >> 10;
+	}
+	sm->window = window;
+}
+
+/*
+ * SMOOTH_Read
+ *  - Channels at time now (TIMEBASE_Now()), ramped between the last two frames.
+ *    Call at the control loop rate; a multiply per channel.
+ */
+uint16_t* SMOOTH_Read ( SMOOTH_t * sm, uint32_t now )
+{
+	uint32_t dt = now - sm->frameTime;
+
+	for ( uint8_t c = 0; c < sm->count; c++ ) {
+		sm->out[c] = SMOOTH_At( sm, c, dt );
+	}
+	return sm->out;
+}
+
+/*
+ * SMOOTH_getDerivative
+ *  - Slope of each channel's ramp in microseconds per second, for feed-forward. Updated per frame.
+ */
+int32_t* SMOOTH_getDerivative ( SMOOTH_t * sm )
+{
+	return sm->deriv;
+}
+
+/*
+ * SMOOTH_getInterval
+ *  - Average frame interval in microseconds, 0 until two frames from the same source.
+ */
+uint32_t SMOOTH_getInterval ( const SMOOTH_t * sm )
+{
+	return sm->interval >> 4;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * SMOOTH_At
+ *  - Channel c, dt microseconds into the current ramp.
+ */
+static uint16_t SMOOTH_At ( const SMOOTH_t * sm, uint8_t c, uint32_t dt )
+{
+	if ( dt >= sm->window ) { return sm->target[c]; }
+
+	return (uint16_t)( sm->base[c] + ((sm->rate[c] * (int32_t)dt) >> 16) );
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,65 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef SMOOTH_H
+#define SMOOTH_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Inter-frame smoothing. Each new frame starts a linear ramp from where the outputs
+ * are to the new values, spread over the measured frame interval. Reading between
+ * frames then gives a continuous signal at any loop rate rather than a step per frame,
+ * at the cost of one frame interval of latency.
+ *
+ * The interval is a running average of the frame timestamps, so the ramp follows the
+ * link rate by itself. It restarts when the frames change source or stop for longer
+ * than SMOOTH_GAP_US.
+ */
+#ifndef SMOOTH_CH_NUM
+#define SMOOTH_CH_NUM			16		// Channels smoothed, later ones are not read
+#endif
+
+#define SMOOTH_GAP_US			100000	// Longer without frames restarts the ramps
+#define SMOOTH_WINDOW_MIN_US	1000	// Shortest ramp, bounds the slope for the Q16 maths
+#define SMOOTH_AVG_SHIFT		3		// Interval average weight, settles in ~8 frames
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef struct {
+	uint8_t		id;						/* Source of the frames, a change restarts	*/
+	uint8_t		count;					/* Channels, 0 before the first frame		*/
+	uint8_t		frames;					/* Intervals averaged, saturates			*/
+	uint32_t	frameTime;				/* Timestamp of the last frame				*/
+	uint32_t	interval;				/* Average frame interval, us Q4			*/
+	uint32_t	window;					/* Ramp length of the last frame, us		*/
+	uint16_t	base[SMOOTH_CH_NUM];	/* Outputs at the last frame				*/
+	uint16_t	target[SMOOTH_CH_NUM];	/* Channels of the last frame				*/
+	int32_t		rate[SMOOTH_CH_NUM];	/* Ramp slope, us per us Q16				*/
+	int32_t		deriv[SMOOTH_CH_NUM];	/* Ramp slope, us per second				*/
+	uint16_t	out[SMOOTH_CH_NUM];
+} SMOOTH_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void 		SMOOTH_Init			( SMOOTH_t * );
+void 		SMOOTH_Frame		( SMOOTH_t *, const uint16_t *, uint8_t, uint32_t, uint8_t );
+uint16_t*	SMOOTH_Read			( SMOOTH_t *, uint32_t );
+
+int32_t*	SMOOTH_getDerivative( SMOOTH_t * );
+uint32_t	SMOOTH_getInterval	( const SMOOTH_t * );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* SMOOTH_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,219 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Storage.h"
+#include "Radio.h"
+
+#ifdef RADIO_USE_STORAGE
+
+#ifdef STORAGE_FILE
+#include <stdio.h>
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#if !defined(STORAGE_FILE) && !defined(STORAGE_ADDRESS)
+#error "error: STORAGE_ADDRESS needs to be defined as a free flash page (e.g FLASH_BASE + 31 * FLASH_PAGE_SIZE)"
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef enum {
+	STORAGE_LastGood	= 0x01,
+	STORAGE_Calib		= 0x02,
+} STORAGE_part_t;
+
+/* Everything stored, as laid out in the file or flash page */
+typedef struct {
+	uint32_t			magic;		/* STORAGE_MAGIC, anything else is blank	*/
+	uint32_t			valid;		/* STORAGE_part_t of the parts written		*/
+	RADIO_lastGood_t	lastGood;
+#ifdef RADIO_USE_CALIBRATION
+	CALIB_record_t		calib;
+#endif
+} STORAGE_record_t;
+
+#define STORAGE_WORDS			((sizeof(STORAGE_record_t) + 3) / 4)
+
+/* Flash is programmed a word at a time */
+typedef union {
+	STORAGE_record_t	rec;
+	uint32_t			words[STORAGE_WORDS];
+} STORAGE_page_t;
+
+#if defined(STORAGE_ADDRESS) && !defined(STORAGE_FILE)
+_Static_assert( sizeof(STORAGE_page_t) <= FLASH_PAGE_SIZE, "error: storage record is larger than a flash page" );
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static bool 	STORAGE_Read		( STORAGE_page_t * );
+static bool 	STORAGE_Write		( const STORAGE_page_t * );
+static void 	STORAGE_Modify		( STORAGE_page_t * );
+
+static bool 	STORAGE_opsLoad		( RADIO_lastGood_t * );
+static bool 	STORAGE_opsSave		( const RADIO_lastGood_t * );
+#ifdef RADIO_USE_CALIBRATION
+static bool 	STORAGE_opsLoadCal	( CALIB_record_t * );
+static bool 	STORAGE_opsSaveCal	( const CALIB_record_t * );
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+const RADIO_storage_t STORAGE_ops = {
+	.load		= STORAGE_opsLoad,
+	.save		= STORAGE_opsSave,
+#ifdef RADIO_USE_CALIBRATION
+	.loadCal	= STORAGE_opsLoadCal,
+	.saveCal	= STORAGE_opsSaveCal,
+#endif
+};
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * STORAGE_Erase
+ *  - Forgets everything stored. The next RADIO_Init() runs a full detection.
+ *  - Returns false if the file or page could not be erased.
+ */
+bool STORAGE_Erase ( void )
+{
+#ifdef STORAGE_FILE
+	FILE * f = fopen( STORAGE_FILE, "rb" );
+	if ( f == NULL ) { return true; }
+	fclose( f );
+	return remove( STORAGE_FILE ) == 0;
+#else
+	STORAGE_page_t page;
+	memset( &page, 0, sizeof(page) );
+	return STORAGE_Write( &page );
+#endif
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * STORAGE_Read
+ *  - The stored record. False if there is none, or it is from another layout.
+ */
+static bool STORAGE_Read ( STORAGE_page_t * page )
+{
+#ifdef STORAGE_FILE
+	FILE * f = fopen( STORAGE_FILE, "rb" );
+	if ( f == NULL ) { return false; }
+	bool read = fread( page, sizeof(*page), 1, f ) == 1;
+	fclose( f );
+	if ( !read ) { return false; }
+#else
+	memcpy( page, (const void *)(STORAGE_ADDRESS), sizeof(*page) );
+#endif
+	return page->rec.magic == STORAGE_MAGIC;
+}
+
+/*
+ * STORAGE_Write
+ *  - Replaces the stored record.
+ */
+static bool STORAGE_Write ( const STORAGE_page_t * page )
+{
+#ifdef STORAGE_FILE
+	FILE * f = fopen( STORAGE_FILE, "wb" );
+	if ( f == NULL ) { return false; }
+	bool written = fwrite( page, sizeof(*page), 1, f ) == 1;
+	return ( fclose( f ) == 0 ) && written;
+#else
+	FLASH_EraseInitTypeDef erase = {
+		.TypeErase		= FLASH_TYPEERASE_PAGES,
+		.PageAddress	= STORAGE_ADDRESS,
+		.NbPages		= 1,
+	};
+	uint32_t fault;
+
+	HAL_FLASH_Unlock();
+	bool written = HAL_FLASHEx_Erase( &erase, &fault ) == HAL_OK;
+	for ( uint32_t i = 0; written && i < STORAGE_WORDS; i++ ) {
+		written = HAL_FLASH_Program( FLASH_TYPEPROGRAM_WORD, STORAGE_ADDRESS + i * 4, page->words[i] ) == HAL_OK;
+	}
+	HAL_FLASH_Lock();
+
+	// Read back, a write that did not take would otherwise pass for a save
+	return written && memcmp( (const void *)(STORAGE_ADDRESS), page, sizeof(*page) ) == 0;
+#endif
+}
+
+/*
+ * STORAGE_Modify
+ *  - The stored record to change a part of, or a blank one.
+ */
+static void STORAGE_Modify ( STORAGE_page_t * page )
+{
+	if ( !STORAGE_Read( page ) ) {
+		memset( page, 0, sizeof(*page) );
+		page->rec.magic = STORAGE_MAGIC;
+	}
+}
+
+/*
+ * STORAGE_ops entries
+ *  - Each part is only loaded once it has been saved.
+ */
+static bool STORAGE_opsLoad ( RADIO_lastGood_t * lg )
+{
+	STORAGE_page_t page;
+	if ( !STORAGE_Read( &page ) || !(page.rec.valid & STORAGE_LastGood) ) { return false; }
+
+	*lg = page.rec.lastGood;
+	return true;
+}
+
+static bool STORAGE_opsSave ( const RADIO_lastGood_t * lg )
+{
+	STORAGE_page_t page;
+	STORAGE_Modify( &page );
+	page.rec.lastGood	 = *lg;
+	page.rec.valid		|= STORAGE_LastGood;
+	return STORAGE_Write( &page );
+}
+
+#ifdef RADIO_USE_CALIBRATION
+static bool STORAGE_opsLoadCal ( CALIB_record_t * rec )
+{
+	STORAGE_page_t page;
+	if ( !STORAGE_Read( &page ) || !(page.rec.valid & STORAGE_Calib) ) { return false; }
+
+	*rec = page.rec.calib;
+	return true;
+}
+
+static bool STORAGE_opsSaveCal ( const CALIB_record_t * rec )
+{
+	STORAGE_page_t page;
+	STORAGE_Modify( &page );
+	page.rec.calib	 = *rec;
+	page.rec.valid	|= STORAGE_Calib;
+	return STORAGE_Write( &page );
+}
+#endif
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
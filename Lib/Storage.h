@@ -0,0 +1,33 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef STORAGE_H
+#define STORAGE_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Ready made persistence for RADIO_setStorage( &STORAGE_ops ). The last good
+ * configuration and the calibration share one record, rewritten whole.
+ *
+ *  - STORAGE_FILE:		host build, the record is kept in this file (e.g "radio.bin").
+ *  - STORAGE_ADDRESS:	on target, a flash page of its own (e.g the last one). Written
+ *						through the HAL, page erase and word program as on STM32F0/L0.
+ *
+ * The library only saves when the locked configuration changes, so the page sees
+ * a write per receiver change rather than per boot.
+ */
+#define STORAGE_MAGIC			0x52414402		// Layout version in the low byte
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+bool 		STORAGE_Erase		( void );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* STORAGE_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
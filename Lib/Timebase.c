@@ -0,0 +1,157 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Timebase.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE PROTOTYPES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * TIMEBASE_Now
+ *  - Current time (us).
+ */
+uint32_t TIMEBASE_Now ( void )
+{
+	return US_Read();
+}
+
+/*
+ * TIMEBASE_Since
+ *  - Time (us) since t, across a wrap.
+ */
+uint32_t TIMEBASE_Since ( uint32_t t )
+{
+	return TIMEBASE_Now() - t;
+}
+
+/*
+ * TIMEBASE_Elapsed
+ *  - True once at least us have passed since t.
+ */
+bool TIMEBASE_Elapsed ( uint32_t t, uint32_t us )
+{
+	return TIMEBASE_Since( t ) >= us;
+}
+
+/*
+ * TIMEBASE_Deadline
+ *  - Time us from now, for TIMEBASE_Expired().
+ */
+uint32_t TIMEBASE_Deadline ( uint32_t us )
+{
+	return TIMEBASE_Now() + us;
+}
+
+/*
+ * TIMEBASE_Expired
+ *  - True once the deadline is reached. Compares the signed difference, so it
+ *    stays correct when the deadline lies across a wrap.
+ */
+bool TIMEBASE_Expired ( uint32_t deadline )
+{
+	return (int32_t)(TIMEBASE_Now() - deadline) >= 0;
+}
+
+/*
+ * TIMEBASE_CharUs
+ *  - Time (us) one UART character of bits (start, data, parity and stop) takes
+ *    on the wire at baud, rounded up.
+ */
+uint32_t TIMEBASE_CharUs ( uint32_t baud, uint8_t bits )
+{
+	if ( baud == 0 ) { return 0; }
+
+	return ((uint32_t)bits * TIMEBASE_US_PER_S + baud - 1) / baud;
+}
+
+/*
+ * TIMEBASE_RateInit
+ *  - Starts a frame rate estimate. maxUs is the decoder's fixed timeout.
+ */
+void TIMEBASE_RateInit ( TIMEBASE_rate_t * rate, uint32_t maxUs )
+{
+	memset( rate, 0, sizeof(*rate) );
+	rate->max		= maxUs;
+	rate->timeout	= maxUs;
+}
+
+/*
+ * TIMEBASE_RateFrame
+ *  - Adds the frame received at t. frames: frames since the last one added, as
+ *    the decoder may commit only the newest of several.
+ *  - Gaps as long as the fixed timeout are outages, not intervals, and are skipped.
+ */
+void TIMEBASE_RateFrame ( TIMEBASE_rate_t * rate, uint32_t t, uint32_t frames )
+{
+	uint32_t gap = t - rate->last;
+	bool first	 = ( rate->last == 0 && rate->samples == 0 );
+	rate->last	 = t;
+
+	if ( first || frames == 0 || gap >= rate->max ) { return; }
+	if ( frames > 1 ) { gap /= frames; }
+
+	// Averages over about 8 intervals, in Q4 so slow links keep their fraction
+	uint32_t sample = gap << 4;
+	if ( rate->samples == 0 ) {
+		rate->interval	= sample;
+	} else {
+		uint32_t dev	= sample > rate->interval ? sample - rate->interval : rate->interval - sample;
+		rate->interval	= rate->interval - (rate->interval >> 3) + (sample >> 3);
+		rate->jitter	= rate->jitter - (rate->jitter >> 3) + (dev >> 3);
+	}
+	if ( rate->samples < TIMEBASE_RATE_SETTLE ) {
+		rate->samples++;
+	}
+
+	if ( TIMEBASE_TIMEOUT_FRAMES > 0 && rate->samples >= TIMEBASE_RATE_SETTLE ) {
+		uint32_t timeout = (TIMEBASE_TIMEOUT_FRAMES * rate->interval + 4 * rate->jitter) >> 4;
+		if ( timeout < TIMEBASE_MS(TIMEBASE_TIMEOUT_MIN_MS) ) { timeout = TIMEBASE_MS(TIMEBASE_TIMEOUT_MIN_MS); }
+		rate->timeout = timeout < rate->max ? timeout : rate->max;
+	}
+}
+
+/*
+ * TIMEBASE_RateTimeout
+ *  - Time (us) without frames after which the input is lost.
+ */
+uint32_t TIMEBASE_RateTimeout ( TIMEBASE_rate_t * rate )
+{
+	return rate->timeout;
+}
+
+/*
+ * TIMEBASE_RateInterval
+ *  - Average frame interval (us), 0 until measured.
+ */
+uint32_t TIMEBASE_RateInterval ( TIMEBASE_rate_t * rate )
+{
+	return rate->samples >= TIMEBASE_RATE_SETTLE ? rate->interval >> 4 : 0;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EVENT HANDLERS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* INTERRUPT ROUTINES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
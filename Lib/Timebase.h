@@ -0,0 +1,74 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+#include "US.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Microsecond clock shared by every decoder, backed by US_Read() so US_Init()
+ * must have been called. Times are free running uint32_t and wrap every ~71
+ * minutes; compare them only through the helpers below, which are wrap-safe
+ * for intervals shorter than half that.
+ */
+#define TIMEBASE_US_PER_MS		1000
+#define TIMEBASE_US_PER_S		1000000
+#define TIMEBASE_MS(ms)			((uint32_t)(ms) * TIMEBASE_US_PER_MS)
+
+/*
+ * Failsafe timeouts follow the measured frame rate: TIMEBASE_TIMEOUT_FRAMES frame
+ * intervals plus four times the jitter, no less than TIMEBASE_TIMEOUT_MIN_MS and no
+ * more than the decoder's fixed timeout, which also applies until the rate is known.
+ * TIMEBASE_TIMEOUT_FRAMES 0 keeps the fixed timeouts.
+ */
+#ifndef TIMEBASE_TIMEOUT_FRAMES
+#define TIMEBASE_TIMEOUT_FRAMES	3		// Frames missed before the input is lost
+#endif
+#ifndef TIMEBASE_TIMEOUT_MIN_MS
+#define TIMEBASE_TIMEOUT_MIN_MS	10
+#endif
+#define TIMEBASE_RATE_SETTLE	8		// Intervals measured before the timeout adapts
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Frame rate of one input and the failsafe timeout that follows from it, see TIMEBASE_Rate* */
+typedef struct {
+	uint32_t	last;		// Time of the last frame
+	uint8_t		samples;	// Intervals measured, up to TIMEBASE_RATE_SETTLE
+	uint32_t	interval;	// Average frame interval (us, Q4)
+	uint32_t	jitter;		// Average deviation from it (us, Q4)
+	uint32_t	max;		// Fixed timeout (us), the upper bound
+	uint32_t	timeout;	// Current timeout (us)
+} TIMEBASE_rate_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+uint32_t	TIMEBASE_Now		( void );
+uint32_t	TIMEBASE_Since		( uint32_t );
+bool 		TIMEBASE_Elapsed	( uint32_t, uint32_t );
+uint32_t	TIMEBASE_Deadline	( uint32_t );
+bool 		TIMEBASE_Expired	( uint32_t );
+uint32_t	TIMEBASE_CharUs		( uint32_t, uint8_t );
+
+void 		TIMEBASE_RateInit	( TIMEBASE_rate_t *, uint32_t );
+void 		TIMEBASE_RateFrame	( TIMEBASE_rate_t *, uint32_t, uint32_t );
+uint32_t	TIMEBASE_RateTimeout( TIMEBASE_rate_t * );
+uint32_t	TIMEBASE_RateInterval( TIMEBASE_rate_t * );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* EXTERN DECLARATIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* TIMEBASE_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,122 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Glitch filter test, on PWM. The channels pulse one after another, and every pulse
+ * is an update, so a spike on CH1 is still in the decoder's buffer while CH2 to CH4
+ * pulse. Each mode has to keep a one period spike on CH1 within its limit over all of
+ * those updates, and still take a real step within two periods.
+ */
+#include "Radio.h"
+#include "Host.h"
+
+#include <stdio.h>
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#define TEST_LOCK_PERIODS		50
+#define TEST_SETTLE_PERIODS		5
+#define TEST_LIMIT				100
+#define TEST_REST				1500
+#define TEST_SPIKE				1900
+#define TEST_STEP				1800
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static const uint32_t pins[PWM_CH_NUM] = { PWM_CH1_Pin, PWM_CH2_Pin, PWM_CH3_Pin, PWM_CH4_Pin };
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * TEST_Period
+ *  - Pulses every channel in turn, CH1 at ch1 and the others at rest, with an update
+ *    after each pulse. Returns the highest CH1 output seen over the period.
+ */
+static uint16_t TEST_Period ( uint16_t ch1 )
+{
+	uint16_t highest = 0;
+
+	for ( uint8_t c = 0; c < PWM_CH_NUM; c++ ) {
+		uint16_t width = c == CH1 ? ch1 : TEST_REST;
+		HOST_SetPin( pins[c], true );
+		HOST_Advance( width );
+		HOST_SetPin( pins[c], false );
+		HOST_Advance( PWM_PERIOD_US / PWM_CH_NUM - width );
+		RADIO_Update();
+
+		uint16_t * out = RADIO_getData();
+		if ( out != NULL && out[CH1] > highest ) { highest = out[CH1]; }
+	}
+	return highest;
+}
+
+/*
+ * TEST_Mode
+ *  - Runs the spike and the step through one filter mode. Returns the errors.
+ */
+static uint32_t TEST_Mode ( FILTER_mode_t mode, uint16_t allowed )
+{
+	FILTER_channel_t table[PWM_CH_NUM];
+	for ( uint8_t c = 0; c < PWM_CH_NUM; c++ ) {
+		table[c].mode  = mode;
+		table[c].limit = TEST_LIMIT;
+	}
+
+	HOST_Reset();
+	RADIO_setFilter( table, PWM_CH_NUM );
+	RADIO_Init( PWM );
+
+	for ( uint32_t n = 0; RADIO_getDetectState() != RADIO_Detect_Locked; n++ ) {
+		if ( n >= TEST_LOCK_PERIODS ) {
+			printf( "mode %u: PWM did not lock\n", mode );
+			RADIO_Deinit();
+			return 1;
+		}
+		TEST_Period( TEST_REST );
+	}
+
+	uint32_t errors = 0;
+	for ( uint32_t n = 0; n < TEST_SETTLE_PERIODS; n++ ) {
+		TEST_Period( TEST_REST );
+	}
+
+	uint16_t spike = TEST_Period( TEST_SPIKE );
+	uint16_t after = TEST_Period( TEST_REST );
+	spike = RADIO_MAX( spike, after );
+	if ( spike > allowed ) {
+		printf( "mode %u: spike reached %u\n", mode, spike );
+		errors++;
+	}
+
+	TEST_Period( TEST_STEP );
+	uint16_t step = TEST_Period( TEST_STEP );
+	if ( step != TEST_STEP ) {
+		printf( "mode %u: step reached %u\n", mode, step );
+		errors++;
+	}
+
+	RADIO_Deinit();
+	return errors;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+int main ( void )
+{
+	uint32_t errors = 0;
+	errors += TEST_Mode( FILTER_Median, TEST_REST );
+	errors += TEST_Mode( FILTER_RateLimit, TEST_REST + TEST_LIMIT );
+	errors += TEST_Mode( FILTER_Confirm, TEST_REST );
+
+	printf( "%u errors\n", errors );
+	return errors == 0 ? 0 : 1;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,167 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Snapshot stress test. One thread feeds SBUS frames through RADIO_Update() while
+ * reader threads copy snapshots as fast as they can. Every copy must be a single
+ * published frame: channels, lost flags and frame sequence from the same frame.
+ *
+ * The frames repeat every TEST_PATTERN. The writer runs one pattern on its own
+ * first and records the outputs of each frame sequence, which the readers then
+ * check every copy against.
+ */
+#include "Radio.h"
+#include "Host.h"
+
+#include <pthread.h>
+#include <stdio.h>
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#define TEST_FRAMES				200000
+#define TEST_READERS			3
+#define TEST_PATTERN			64		// Power of two, so frame sequence wraps line up
+#define TEST_PERIOD_US			(SBUS_PERIOD_ANALOGUE * 1000)
+#define TEST_LOCK_FRAMES		500
+
+#define TEST_FAILSAFE			0x08	// SBUS flags byte, every channel lost
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef struct {
+	uint8_t			chCount;
+	RADIO_chMask_t	chLost;
+	uint16_t		ch[RADIO_CH_NUM_MAX];
+} TEST_expect_t;
+
+typedef struct {
+	uint32_t		copies;
+	uint32_t		errors;
+} TEST_reader_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static TEST_expect_t expect[TEST_PATTERN];
+static bool done;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * TEST_Frame
+ *  - Sends frame n of the pattern and runs one update. Every channel differs from
+ *    frame to frame, and every fourth frame has the failsafe flag set.
+ */
+static void TEST_Frame ( uint32_t n )
+{
+	uint32_t p = n % TEST_PATTERN;
+	uint16_t ch[HOST_SBUS_CH_NUM];
+
+	for ( uint8_t c = 0; c < HOST_SBUS_CH_NUM; c++ ) {
+		ch[c] = SBUS_MIN + (p * 97 + c * 211) % SBUS_RANGE;
+	}
+
+	HOST_SbusWrite( SBUS_UART, ch, ( p % 4 == 3 ) ? TEST_FAILSAFE : 0 );
+	HOST_Advance( TEST_PERIOD_US );
+	RADIO_Update();
+}
+
+/*
+ * TEST_Matches
+ *  - True if a copy is the frame recorded for its frame sequence.
+ */
+static bool TEST_Matches ( const RADIO_snapshot_t * s )
+{
+	const TEST_expect_t * e = &expect[s->frameSeq % TEST_PATTERN];
+	return s->chCount == e->chCount && s->chLost == e->chLost
+		&& s->inputLost == (e->chLost != 0)
+		&& memcmp( s->ch, e->ch, e->chCount * sizeof(e->ch[0]) ) == 0;
+}
+
+/*
+ * TEST_Reader
+ *  - Copies snapshots until the writer is done, counting copies that do not match.
+ */
+static void * TEST_Reader ( void * arg )
+{
+	TEST_reader_t * r = arg;
+	uint32_t last = 0;
+
+	while ( !__atomic_load_n( &done, __ATOMIC_ACQUIRE ) )
+	{
+		RADIO_snapshot_t s;
+		if ( !RADIO_getSnapshot( &s ) ) { continue; }
+
+		// Snapshots only ever move forward
+		if ( s.seq < last || !TEST_Matches( &s ) ) {
+			if ( r->errors++ < 5 ) {
+				printf( "bad copy: seq %u frameSeq %u chLost %x ch0 %u\n", s.seq, s.frameSeq, s.chLost, s.ch[0] );
+			}
+		}
+		last = s.seq;
+		r->copies++;
+	}
+	return NULL;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+int main ( void )
+{
+	HOST_Reset();
+	RADIO_Init( SBUS );
+
+	uint32_t n = 0;
+	while ( RADIO_getDetectState() != RADIO_Detect_Locked ) {
+		if ( n >= TEST_LOCK_FRAMES ) {
+			printf( "SBUS did not lock\n" );
+			return 1;
+		}
+		TEST_Frame( n++ );
+	}
+
+	// One pattern on its own gives the outputs of each frame sequence
+	for ( uint32_t i = 0; i < TEST_PATTERN; i++ ) {
+		TEST_Frame( n++ );
+		TEST_expect_t * e = &expect[RADIO_getFrameSeq() % TEST_PATTERN];
+		e->chCount	= RADIO_getChCount();
+		e->chLost	= RADIO_getInputLost();
+		memcpy( e->ch, RADIO_getData(), e->chCount * sizeof(e->ch[0]) );
+	}
+
+	pthread_t threads[TEST_READERS];
+	TEST_reader_t readers[TEST_READERS] = { 0 };
+	for ( uint8_t i = 0; i < TEST_READERS; i++ ) {
+		pthread_create( &threads[i], NULL, TEST_Reader, &readers[i] );
+	}
+
+	uint32_t errors = 0;
+	for ( uint32_t i = 0; i < TEST_FRAMES; i++ ) {
+		TEST_Frame( n++ );
+		// The writer's own view has to follow the pattern too, or the readers prove nothing
+		RADIO_snapshot_t s;
+		if ( !RADIO_getSnapshot( &s ) || !TEST_Matches( &s ) ) { errors++; }
+	}
+	__atomic_store_n( &done, true, __ATOMIC_RELEASE );
+
+	uint32_t copies = 0;
+	for ( uint8_t i = 0; i < TEST_READERS; i++ ) {
+		pthread_join( threads[i], NULL );
+		copies += readers[i].copies;
+		errors += readers[i].errors;
+	}
+	RADIO_Deinit();
+
+	printf( "%u frames, %u copies by %u readers, %u bad\n", TEST_FRAMES, copies, TEST_READERS, errors );
+	return errors == 0 && copies > 0 ? 0 : 1;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,125 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Storage test, against the STORAGE_FILE backend. A first run detects SBUS from
+ * scratch and saves it. A second run, told to expect CRSF as after a power cycle
+ * with a different guess, has to start the saved SBUS configuration first and lock
+ * within the last good window. The calibration record shares the file and has to
+ * survive both, next to the configuration.
+ */
+#include "Radio.h"
+#include "Host.h"
+
+#include <stdio.h>
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#define TEST_PERIOD_US			(SBUS_PERIOD_ANALOGUE * 1000)
+#define TEST_LOCK_FRAMES		500
+#define TEST_RELOCK_FRAMES		5		// RADIO_LASTGOOD_FRAMES, the window a stored configuration gets
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE FUNCTIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * TEST_Frame
+ *  - Sends one SBUS frame, every channel centred, and runs one update.
+ */
+static void TEST_Frame ( void )
+{
+	uint16_t ch[HOST_SBUS_CH_NUM];
+	for ( uint8_t c = 0; c < HOST_SBUS_CH_NUM; c++ ) {
+		ch[c] = SBUS_MIN + SBUS_RANGE / 2;
+	}
+
+	HOST_SbusWrite( SBUS_UART, ch, 0 );
+	HOST_Advance( TEST_PERIOD_US );
+	RADIO_Update();
+}
+
+/*
+ * TEST_Lock
+ *  - Starts the library guessing protocol, and feeds SBUS until it locks.
+ *  - Returns the frames it took, or 0 if it did not lock within limit.
+ */
+static uint32_t TEST_Lock ( RADIO_protocol_t protocol, uint32_t limit )
+{
+	HOST_Reset();
+	RADIO_setStorage( &STORAGE_ops );
+	RADIO_Init( protocol );
+
+	for ( uint32_t n = 1; n <= limit; n++ ) {
+		TEST_Frame();
+		if ( RADIO_getDetectState() == RADIO_Detect_Locked ) {
+			return RADIO_getProtocol() == SBUS ? n : 0;
+		}
+	}
+	return 0;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+int main ( void )
+{
+	uint32_t errors = 0;
+
+	if ( !STORAGE_Erase() ) {
+		printf( "erase failed\n" );
+		return 1;
+	}
+
+	// Nothing stored yet
+	RADIO_lastGood_t lg;
+	CALIB_record_t cal;
+	if ( STORAGE_ops.load( &lg ) || STORAGE_ops.loadCal( &cal ) ) {
+		printf( "load from a blank store\n" );
+		errors++;
+	}
+
+	// A calibration saved ahead of the configuration is kept alongside it
+	CALIB_record_t saved = { .chCount = 4 };
+	for ( uint8_t c = 0; c < saved.chCount; c++ ) {
+		saved.min[c]	= 1000 + c;
+		saved.center[c]	= 1500 + c;
+		saved.max[c]	= 2000 + c;
+	}
+	if ( !STORAGE_ops.saveCal( &saved ) ) {
+		printf( "calibration save failed\n" );
+		errors++;
+	}
+
+	uint32_t cold = TEST_Lock( CRSF, TEST_LOCK_FRAMES );
+	RADIO_Deinit();
+	if ( cold == 0 || !STORAGE_ops.load( &lg ) || lg.protocol != SBUS ) {
+		printf( "first run: no SBUS lock saved\n" );
+		errors++;
+	}
+
+	uint32_t warm = TEST_Lock( CRSF, TEST_RELOCK_FRAMES );
+	RADIO_Deinit();
+	if ( warm == 0 ) {
+		printf( "second run: stored SBUS not locked within %u frames\n", TEST_RELOCK_FRAMES );
+		errors++;
+	}
+
+	if ( !STORAGE_ops.loadCal( &cal ) || memcmp( &cal, &saved, sizeof(cal) ) != 0 ) {
+		printf( "calibration lost\n" );
+		errors++;
+	}
+
+	STORAGE_Erase();
+	if ( STORAGE_ops.load( &lg ) ) {
+		printf( "load after erase\n" );
+		errors++;
+	}
+
+	printf( "cold lock %u frames, warm lock %u frames, %u errors\n", cold, warm, errors );
+	return errors == 0 ? 0 : 1;
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -0,0 +1,44 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef BOARD_H
+#define BOARD_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Host board: every protocol gets its own peripheral, so any mix can be built.
+ * Pins are bit masks, as on target.
+ */
+#define PA0					(1UL << 0)
+#define PA1					(1UL << 1)
+#define PA2					(1UL << 2)
+#define PA3					(1UL << 3)
+#define PA8					(1UL << 8)
+#define PA10				(1UL << 10)
+#define GPIO_PIN_7			(1UL << 7)
+#define GPIO_AF0_USART1		0
+
+// PWM
+#define PWM_CH1_Pin			PA0
+#define PWM_CH2_Pin			PA1
+#define PWM_CH3_Pin			PA2
+#define PWM_CH4_Pin			PA3
+#define PWM_TIM				TIM_2
+#define PWM_TIM_FREQ		1000000
+#define PWM_TIM_RELOAD		0xFFFFFFFF
+
+// PPM
+#define PPM_CH_Pin			PA8
+#define TIM_RADIO			TIM_3
+#define TIM_RADIO_FREQ		1000000
+#define TIM_RADIO_RELOAD	0xFFFFFFFF
+
+// Serial
+#define CRSF_UART			UART_1
+#define UART1_PINS			GPIO_PIN_7
+#define UART1_AF			GPIO_AF0_USART1
+#define SBUS_UART			UART_2
+#define IBUS_UART			UART_3
+#define AUTOBAUD_Pin		PA10
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* BOARD_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
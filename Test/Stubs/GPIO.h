@@ -0,0 +1,37 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef GPIO_H
+#define GPIO_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC TYPES      									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef enum {
+	GPIO_Pull_None,
+	GPIO_Pull_Up,
+	GPIO_Pull_Down,
+} GPIO_Pull_t;
+
+typedef enum {
+	GPIO_IT_None,
+	GPIO_IT_Rising,
+	GPIO_IT_Falling,
+	GPIO_IT_Both,
+} GPIO_IT_Dir_t;
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+// Pins are bit masks of up to 32 host pins, levels are set with HOST_SetPin()
+void 		GPIO_EnableInput	( uint32_t, GPIO_Pull_t );
+void 		GPIO_Deinit			( uint32_t );
+bool 		GPIO_Read			( uint32_t );
+void 		GPIO_OnChange		( uint32_t, GPIO_IT_Dir_t, void (*)(void) );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* GPIO_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
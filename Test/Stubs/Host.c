@@ -0,0 +1,262 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "Host.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#define HOST_PIN_NUM			32
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE TYPES										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+struct UART_s {
+	bool 		running;
+	uint32_t	baud;
+	UART_Mode_t	mode;
+	uint32_t	head;
+	uint32_t	tail;
+	uint8_t		buffer[HOST_UART_SIZE];
+};
+
+struct TIM_s {
+	bool 		running;
+	uint32_t	freq;
+	uint32_t	reload;
+	uint32_t	start;		// Host clock at TIM_Start()
+};
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PRIVATE VARIABLES									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static uint32_t now;		// Host clock, microseconds
+
+static struct UART_s uarts[3];
+UART_t * const UART_1 = &uarts[0];
+UART_t * const UART_2 = &uarts[1];
+UART_t * const UART_3 = &uarts[2];
+
+static struct TIM_s tims[2];
+TIM_t * const TIM_2 = &tims[0];
+TIM_t * const TIM_3 = &tims[1];
+
+static uint32_t pinLevels;
+static uint32_t pinEdges[2];	// Pins interrupting on rising, falling edges
+static void ( *pinHandler[HOST_PIN_NUM] )( void );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * HOST_Reset
+ *  - Clock back to 0, every peripheral stopped and emptied.
+ */
+void HOST_Reset ( void )
+{
+	now = 0;
+	memset( uarts, 0, sizeof(uarts) );
+	memset( tims, 0, sizeof(tims) );
+	pinLevels = 0;
+	memset( pinEdges, 0, sizeof(pinEdges) );
+	memset( pinHandler, 0, sizeof(pinHandler) );
+}
+
+/*
+ * HOST_Advance
+ *  - Moves the clock on by us microseconds.
+ */
+void HOST_Advance ( uint32_t us )
+{
+	now += us;
+}
+
+/*
+ * HOST_UartWrite
+ *  - Bytes received by the UART, if it is running.
+ *  - Returns the number buffered, fewer once the buffer is full.
+ */
+uint32_t HOST_UartWrite ( UART_t * uart, const uint8_t * data, uint32_t count )
+{
+	if ( !uart->running ) { return 0; }
+
+	uint32_t free = HOST_UART_SIZE - (uart->head - uart->tail);
+	count = count < free ? count : free;
+	for ( uint32_t i = 0; i < count; i++ ) {
+		uart->buffer[uart->head++ & (HOST_UART_SIZE - 1)] = data[i];
+	}
+	return count;
+}
+
+/*
+ * HOST_SbusWrite
+ *  - One SBUS frame received by the UART: HOST_SBUS_CH_NUM channels (SBUS values,
+ *    e.g 172 to 1811) packed LSB first, and the flags byte.
+ *  - Returns the number of bytes buffered, as HOST_UartWrite().
+ */
+uint32_t HOST_SbusWrite ( UART_t * uart, const uint16_t * ch, uint8_t flags )
+{
+	uint8_t frame[HOST_SBUS_LEN] = { 0x0F };
+
+	for ( uint8_t c = 0; c < HOST_SBUS_CH_NUM; c++ ) {
+		for ( uint8_t b = 0; b < 11; b++ ) {
+			uint32_t bit = c * 11 + b;
+			if ( (ch[c] >> b) & 1 ) { frame[1 + bit / 8] |= 1 << (bit % 8); }
+		}
+	}
+	frame[HOST_SBUS_LEN - 2] = flags;
+
+	return HOST_UartWrite( uart, frame, sizeof(frame) );
+}
+
+/*
+ * HOST_SetPin
+ *  - Drives the level of the pins, running their change handler on an edge.
+ */
+void HOST_SetPin ( uint32_t pins, bool level )
+{
+	for ( uint8_t p = 0; p < HOST_PIN_NUM; p++ )
+	{
+		uint32_t bit = 1UL << p;
+		if ( !(pins & bit) || ((pinLevels & bit) != 0) == level ) { continue; }
+
+		pinLevels ^= bit;
+		if ( (pinEdges[level ? 0 : 1] & bit) && pinHandler[p] != NULL ) {
+			pinHandler[p]();
+		}
+	}
+}
+
+/*
+ * Core
+ */
+uint32_t CORE_GetTick ( void )
+{
+	return now / 1000;
+}
+
+void CORE_Idle ( void )
+{
+	now++;
+}
+
+/*
+ * US
+ */
+void US_Init ( void )
+{
+}
+
+uint32_t US_Read ( void )
+{
+	return now;
+}
+
+void US_Delay ( uint32_t us )
+{
+	now += us;
+}
+
+/*
+ * UART
+ */
+void UART_Init ( UART_t * uart, uint32_t baud, UART_Mode_t mode )
+{
+	memset( uart, 0, sizeof(*uart) );
+	uart->running	= true;
+	uart->baud		= baud;
+	uart->mode		= mode;
+}
+
+void UART_Deinit ( UART_t * uart )
+{
+	uart->running = false;
+}
+
+uint32_t UART_ReadCount ( UART_t * uart )
+{
+	return uart->head - uart->tail;
+}
+
+uint32_t UART_Read ( UART_t * uart, uint8_t * data, uint32_t count )
+{
+	uint32_t ready = UART_ReadCount( uart );
+	count = count < ready ? count : ready;
+	for ( uint32_t i = 0; i < count; i++ ) {
+		data[i] = uart->buffer[uart->tail++ & (HOST_UART_SIZE - 1)];
+	}
+	return count;
+}
+
+void UART_ReadFlush ( UART_t * uart )
+{
+	uart->tail = uart->head;
+}
+
+/*
+ * TIM
+ */
+void TIM_Init ( TIM_t * tim, uint32_t freq, uint32_t reload )
+{
+	tim->running	= false;
+	tim->freq		= freq;
+	tim->reload		= reload;
+}
+
+void TIM_Deinit ( TIM_t * tim )
+{
+	tim->running = false;
+}
+
+void TIM_Start ( TIM_t * tim )
+{
+	tim->running	= true;
+	tim->start		= now;
+}
+
+uint32_t TIM_Read ( TIM_t * tim )
+{
+	if ( !tim->running ) { return 0; }
+
+	uint64_t ticks = (uint64_t)(now - tim->start) * tim->freq / 1000000;
+	return (uint32_t)(ticks % ((uint64_t)tim->reload + 1));
+}
+
+/*
+ * GPIO
+ */
+void GPIO_EnableInput ( uint32_t pins, GPIO_Pull_t pull )
+{
+	(void)pins;
+	(void)pull;
+}
+
+void GPIO_Deinit ( uint32_t pins )
+{
+	GPIO_OnChange( pins, GPIO_IT_None, NULL );
+}
+
+bool GPIO_Read ( uint32_t pins )
+{
+	return (pinLevels & pins) != 0;
+}
+
+void GPIO_OnChange ( uint32_t pins, GPIO_IT_Dir_t dir, void (*callback)(void) )
+{
+	for ( uint8_t p = 0; p < HOST_PIN_NUM; p++ )
+	{
+		uint32_t bit = 1UL << p;
+		if ( !(pins & bit) ) { continue; }
+
+		pinEdges[0] &= ~bit;
+		pinEdges[1] &= ~bit;
+		if ( dir == GPIO_IT_Rising || dir == GPIO_IT_Both )  { pinEdges[0] |= bit; }
+		if ( dir == GPIO_IT_Falling || dir == GPIO_IT_Both ) { pinEdges[1] |= bit; }
+		pinHandler[p] = callback;
+	}
+}
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
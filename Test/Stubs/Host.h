@@ -0,0 +1,40 @@
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#ifndef HOST_H
+#define HOST_H
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include "STM32X.h"
+
+#include "Core.h"
+#include "GPIO.h"
+#include "TIM.h"
+#include "UART.h"
+#include "US.h"
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC DEFINITIONS									*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/*
+ * Test side of the stub peripherals. The clock only moves when told to, so runs are
+ * repeatable. Like the hardware, the peripherals belong to the thread that runs
+ * RADIO_Update(); other threads may only use the library's thread safe calls.
+ */
+#define HOST_UART_SIZE			1024	// Bytes buffered per UART, power of two
+
+#define HOST_SBUS_CH_NUM		16		// Channels of an SBUS frame, 11 bits each
+#define HOST_SBUS_LEN			25		// Header, channels, flags and footer
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+/* PUBLIC FUNCTIONS										*/
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void 		HOST_Reset			( void );
+void 		HOST_Advance		( uint32_t );
+uint32_t	HOST_UartWrite		( UART_t *, const uint8_t *, uint32_t );
+uint32_t	HOST_SbusWrite		( UART_t *, const uint16_t *, uint8_t );
+void 		HOST_SetPin			( uint32_t, bool );
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+#endif /* HOST_H */
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */